@@ -0,0 +1,227 @@
+#pragma once
+// Minimal Google Benchmark style harness: register functions with BENCHMARK,
+// time them with auto-calibrated iteration counts, report as a table or as
+// Google Benchmark compatible JSON so results can be compared across commits.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+class State {
+public:
+    State(const std::vector<int64_t>& args, int64_t iterations)
+        : args(args), iterations(iterations), done(0), items(0), started(false), realSeconds(0), cpuSeconds(0) {}
+
+    // Loop condition; the clock runs from the first call until it returns false,
+    // so setup before the loop isn't timed
+    bool keepRunning() {
+        if (!started) {
+            started = true;
+            realStart = std::chrono::steady_clock::now();
+            cpuStart = std::clock();
+        }
+        if (done < iterations) {
+            done++;
+            return true;
+        }
+        realSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+        cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        return false;
+    }
+
+    int64_t range(size_t i = 0) const { return i < args.size() ? args[i] : 0; }
+    int64_t maxIterations() const { return iterations; }
+
+    // Work done over the whole run, reported as items per second
+    void setItemsProcessed(int64_t count) { items = count; }
+    void setLabel(const std::string& text) { label = text; }
+
+    const std::vector<int64_t> args;
+    const int64_t iterations;
+    int64_t done;
+    int64_t items;
+    std::string label;
+    bool started;
+    double realSeconds, cpuSeconds;
+
+private:
+    std::chrono::steady_clock::time_point realStart;
+    std::clock_t cpuStart;
+};
+
+// Keep a computed value alive so the optimizer can't drop the work
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark {
+    std::string name;
+    std::function<void(State&)> function;
+    std::vector<std::vector<int64_t>> argSets;
+
+    Benchmark* arg(int64_t a) {
+        argSets.push_back({a});
+        return this;
+    }
+    Benchmark* args(const std::vector<int64_t>& a) {
+        argSets.push_back(a);
+        return this;
+    }
+    // a, a*multiplier, ... up to and including hi
+    Benchmark* range(int64_t lo, int64_t hi, int64_t multiplier = 10) {
+        for (int64_t a = lo; a < hi; a *= multiplier) argSets.push_back({a});
+        argSets.push_back({hi});
+        return this;
+    }
+};
+
+inline std::vector<Benchmark*>& registry() {
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+inline Benchmark* registerBenchmark(const char* name, void (*function)(State&)) {
+    Benchmark* benchmark = new Benchmark{name, function, {}};
+    registry().push_back(benchmark);
+    return benchmark;
+}
+
+struct Result {
+    std::string name;
+    std::string label;
+    int64_t iterations;
+    double realNs, cpuNs; // Per iteration
+    double itemsPerSecond;
+};
+
+inline std::string runName(const Benchmark& benchmark, const std::vector<int64_t>& args) {
+    std::string name = benchmark.name;
+    for (int64_t a : args) name += "/" + std::to_string(a);
+    return name;
+}
+
+inline Result runOne(const Benchmark& benchmark, const std::vector<int64_t>& args, double minSeconds) {
+    std::string name = runName(benchmark, args);
+
+    // Grow the iteration count until one run takes at least minSeconds
+    int64_t iterations = 1;
+    while (true) {
+        State state(args, iterations);
+        benchmark.function(state);
+        bool enough = state.realSeconds >= minSeconds || iterations >= 1000000000;
+        if (enough) {
+            Result result;
+            result.name = name;
+            result.label = state.label;
+            result.iterations = iterations;
+            result.realNs = state.realSeconds * 1e9 / iterations;
+            result.cpuNs = state.cpuSeconds * 1e9 / iterations;
+            result.itemsPerSecond = state.items > 0 && state.realSeconds > 0 ? state.items / state.realSeconds : 0;
+            return result;
+        }
+        double scale = state.realSeconds > 0 ? minSeconds * 1.4 / state.realSeconds : 100;
+        scale = scale < 2 ? 2 : (scale > 100 ? 100 : scale);
+        iterations = static_cast<int64_t>(iterations * scale);
+    }
+}
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+inline void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"run_type\": \"iteration\""
+            << ", \"iterations\": " << r.iterations << ", \"real_time\": " << r.realNs << ", \"cpu_time\": " << r.cpuNs
+            << ", \"time_unit\": \"ns\"";
+        if (r.itemsPerSecond > 0) out << ", \"items_per_second\": " << r.itemsPerSecond;
+        if (!r.label.empty()) out << ", \"label\": \"" << jsonEscape(r.label) << "\"";
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// --filter SUBSTRING, --min-time SECONDS, --json FILE (or - for stdout)
+inline int runAll(int argc, char* argv[]) {
+    std::string filter, jsonPath;
+    double minSeconds = 0.5;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter SUBSTRING] [--min-time SECONDS] [--json FILE|-]" << std::endl;
+            return 1;
+        }
+    }
+
+    // The table goes to stderr when JSON takes stdout
+    FILE* table = jsonPath == "-" ? stderr : stdout;
+    std::fprintf(table, "%-44s %14s %14s %12s %16s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations", "items/s");
+
+    std::vector<Result> results;
+    for (const Benchmark* benchmark : registry()) {
+        std::vector<std::vector<int64_t>> argSets = benchmark->argSets;
+        if (argSets.empty()) argSets.push_back({});
+        for (const std::vector<int64_t>& args : argSets) {
+            if (!filter.empty() && runName(*benchmark, args).find(filter) == std::string::npos) continue;
+            Result result = runOne(*benchmark, args, minSeconds);
+            std::fprintf(table, "%-44s %14.1f %14.1f %12lld %16.4g %s\n", result.name.c_str(), result.realNs, result.cpuNs,
+                         static_cast<long long>(result.iterations), result.itemsPerSecond, result.label.c_str());
+            std::fflush(table);
+            results.push_back(result);
+        }
+    }
+
+    if (jsonPath == "-") {
+        writeJson(std::cout, results);
+    } else if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Failed to open " << jsonPath << std::endl;
+            return 1;
+        }
+        writeJson(out, results);
+    }
+    return 0;
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(function) \
+    static bench::Benchmark* BENCH_CONCAT(benchmark_, __LINE__) = bench::registerBenchmark(#function, function)
@@ -0,0 +1,84 @@
+// Compares the vectorized gravity kernel against the original per-Vector2D loop
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../include/BodyStore.h"
+#include "../include/Constants.h"
+#include "../include/GravityKernel.h"
+#include "../include/Utils.h"
+
+// Stand-in for the old CelestialBody: one heap object per body
+struct PointerBody {
+    Vector2D position;
+    Vector2D velocity;
+    double mass;
+    double radius;
+    void* texture;
+    int size;
+};
+
+// The pre-BodyStore Spacecraft::calculateAcceleration loop
+static Vector2D vectorPathAcceleration(const std::vector<std::shared_ptr<PointerBody>>& bodies, const Vector2D& pos) {
+    Vector2D acceleration(0, 0);
+    for (const auto& body : bodies) {
+        Vector2D direction = body->position - pos;
+        double distance = direction.magnitude();
+        if (distance < body->radius) continue;
+        double forceMagnitude = GRAVITATIONAL_CONSTANT * body->mass / (distance * distance);
+        acceleration = acceleration + direction.normalized() * forceMagnitude;
+    }
+    return acceleration;
+}
+
+template <typename F>
+static double nanosecondsPerPair(size_t bodyCount, F&& evaluate) {
+    // Enough evaluations for ~20M pair interactions
+    size_t repeats = 20000000 / bodyCount + 1;
+    auto start = std::chrono::steady_clock::now();
+    double sink = 0;
+    for (size_t r = 0; r < repeats; r++) {
+        sink += evaluate(static_cast<double>(r));
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (sink == 42) std::printf(" ");
+    return std::chrono::duration<double, std::nano>(end - start).count() / (repeats * bodyCount);
+}
+
+int main() {
+    const size_t sizes[] = {16, 256, 4096, 100000};
+    const GravityKernel::Path paths[] = {GravityKernel::Path::Scalar, GravityKernel::Path::SSE2,
+                                         GravityKernel::Path::AVX2, GravityKernel::Path::AVX512};
+
+    std::printf("%-8s %-10s %12s\n", "bodies", "path", "ns/pair");
+    for (size_t n : sizes) {
+        std::mt19937_64 rng(12345);
+        std::uniform_real_distribution<double> coord(-1e12, 1e12);
+        std::uniform_real_distribution<double> mass(1e18, 1e24);
+
+        BodyStore store;
+        std::vector<std::shared_ptr<PointerBody>> pointerBodies;
+        for (size_t i = 0; i < n; i++) {
+            Vector2D pos(coord(rng), coord(rng));
+            double m = mass(rng);
+            store.add(m, 1e5, pos, Vector2D());
+            pointerBodies.push_back(std::make_shared<PointerBody>(PointerBody{pos, Vector2D(), m, 1e5, nullptr, 10}));
+        }
+
+        double ns = nanosecondsPerPair(n, [&](double r) {
+            return vectorPathAcceleration(pointerBodies, Vector2D(r, -r)).x;
+        });
+        std::printf("%-8zu %-10s %12.3f\n", n, "vector2d", ns);
+
+        for (GravityKernel::Path path : paths) {
+            if (!GravityKernel::isSupported(path)) continue;
+            ns = nanosecondsPerPair(n, [&](double r) {
+                return store.accelerationAt(Vector2D(r, -r), path).x;
+            });
+            std::printf("%-8zu %-10s %12.3f\n", n, GravityKernel::pathName(path), ns);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+// Physics hot paths: vector math, ship acceleration, integrator steps, trail
+// recording, fleet steps, collision detection, trajectory prediction, transfer
+// planning and full simulation steps. Scenarios are seeded so runs compare across commits; --json
+// writes Google Benchmark compatible output.
+#include <cmath>
+#include <random>
+
+#include "BenchHarness.h"
+#include "../include/Constants.h"
+#include "../include/Simulation.h"
+#include "../include/TrajectoryPredictor.h"
+#include "../include/Lambert.h"
+#include "../include/Porkchop.h"
+#include "../include/MonteCarlo.h"
+
+// Star at the origin plus bodyCount small bodies on circular orbits and the
+// default player ship; same seed, same scenario
+static void seedScenario(Simulation& simulation, size_t bodyCount, uint64_t seed = 12345) {
+    const double starMass = 1.989e30;
+    simulation.bodies.reserve(bodyCount + 1);
+    simulation.addBody(starMass, 696340000, Vector2D(0, 0), Vector2D(0, 0));
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> orbitRadius(1e11, 2e13);
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+    std::uniform_real_distribution<double> mass(1e18, 1e22);
+    for (size_t i = 0; i < bodyCount; i++) {
+        double r = orbitRadius(rng);
+        double a = angle(rng);
+        double speed = std::sqrt(GRAVITATIONAL_CONSTANT * starMass / r);
+        simulation.addBody(mass(rng), 1e5, Vector2D(r * std::cos(a), r * std::sin(a)),
+                           Vector2D(-speed * std::sin(a), speed * std::cos(a)));
+    }
+
+    simulation.ship = std::make_shared<Spacecraft>(1000, Vector2D(1e13, 0), Vector2D(0, 1600), 1000, 50000);
+    simulation.physicsPool.setThreadCount(1);
+}
+
+static void BM_Vector2DOps(bench::State& state) {
+    Vector2D a(1.5, -2.25), b(0.75, 3.5);
+    while (state.keepRunning()) {
+        Vector2D c = (a + b) * 0.5 - a.normalized() * b.magnitude();
+        bench::doNotOptimize(c);
+        a = Vector2D(c.y, a.x);
+    }
+    state.setItemsProcessed(state.maxIterations());
+}
+BENCHMARK(BM_Vector2DOps);
+
+static void calculateAcceleration(bench::State& state, GravitySolver::Mode mode) {
+    Simulation simulation;
+    seedScenario(simulation, static_cast<size_t>(state.range()) - 1);
+    simulation.gravity.setMode(mode);
+    simulation.gravity.prepare();
+
+    const Spacecraft& ship = *simulation.ship;
+    double offset = 0;
+    while (state.keepRunning()) {
+        Vector2D acceleration = ship.calculateAcceleration(simulation.gravity, Vector2D(1e13 + offset, offset));
+        bench::doNotOptimize(acceleration);
+        offset += 1e6;
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range());
+}
+
+// Items are bodies, so items/s is body interactions per second
+static void BM_CalculateAccelerationExact(bench::State& state) {
+    calculateAcceleration(state, GravitySolver::Mode::Exact);
+}
+BENCHMARK(BM_CalculateAccelerationExact)->range(1, 100000);
+
+static void BM_CalculateAccelerationBarnesHut(bench::State& state) {
+    calculateAcceleration(state, GravitySolver::Mode::BarnesHut);
+}
+BENCHMARK(BM_CalculateAccelerationBarnesHut)->range(1, 100000);
+
+// One hour of flight through Spacecraft::update with each integrator
+static void BM_ShipUpdate(bench::State& state) {
+    IntegratorType type = static_cast<IntegratorType>(state.range());
+    Simulation simulation;
+    seedScenario(simulation, 100);
+    simulation.gravity.prepare();
+    simulation.ship->setIntegrator(type);
+    state.setLabel(Integrator::name(type));
+
+    Spacecraft& ship = *simulation.ship;
+    Vector2D startPosition = ship.position, startVelocity = ship.velocity;
+    while (state.keepRunning()) {
+        ship.update(simulation.gravity, 3600);
+        // Same orbit arc every iteration
+        ship.position = startPosition;
+        ship.velocity = startVelocity;
+    }
+}
+BENCHMARK(BM_ShipUpdate)
+    ->arg(static_cast<int64_t>(IntegratorType::Euler))
+    ->arg(static_cast<int64_t>(IntegratorType::RK4))
+    ->arg(static_cast<int64_t>(IntegratorType::DormandPrince45))
+    ->arg(static_cast<int64_t>(IntegratorType::Leapfrog))
+    ->arg(static_cast<int64_t>(IntegratorType::Yoshida4));
+
+// Trail bookkeeping per step; arg is the spacing in meters (0 records every step)
+static void BM_TrailRecord(bench::State& state) {
+    Spacecraft ship(1000, Vector2D(0, 0), Vector2D(0, 0), 0, 0);
+    ship.trailMinDistance = static_cast<double>(state.range());
+    double x = 0;
+    while (state.keepRunning()) {
+        x += 1e6;
+        ship.position = Vector2D(x, 0.5 * x);
+        ship.recordTrail(60);
+    }
+    state.setItemsProcessed(state.maxIterations());
+}
+BENCHMARK(BM_TrailRecord)->arg(0)->arg(100000000);
+
+// Simulation::updatePhysics; items are bodies, so items/s is body-steps per second
+static void BM_UpdatePhysics(bench::State& state) {
+    Simulation simulation;
+    seedScenario(simulation, static_cast<size_t>(state.range()) - 1);
+    while (state.keepRunning()) {
+        simulation.updatePhysics(3600);
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range());
+}
+BENCHMARK(BM_UpdatePhysics)->range(10, 100000);
+
+// One fleet substep (both halves) around a 10-body system on one core; arg is the
+// ship count, items are ship-steps
+static void BM_FleetStep(bench::State& state) {
+    Simulation simulation;
+    seedScenario(simulation, 9);
+    std::mt19937_64 rng(777);
+    std::uniform_real_distribution<double> orbitRadius(1e12, 2e13);
+    std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+    const size_t count = static_cast<size_t>(state.range());
+    simulation.fleet.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        double r = orbitRadius(rng);
+        double a = angle(rng);
+        double speed = std::sqrt(GRAVITATIONAL_CONSTANT * simulation.bodies.mass[0] / r);
+        ShipHandle ship = simulation.fleet.spawn(1000, Vector2D(r * std::cos(a), r * std::sin(a)),
+                                                 Vector2D(-speed * std::sin(a), speed * std::cos(a)), 100, 2000);
+        // Every eighth ship burns, so the propulsion path is exercised
+        if (i % 8 == 0) simulation.fleet.setBurn(ship, true, Vector2D(std::cos(a), std::sin(a)));
+    }
+    simulation.gravity.prepare();
+    while (state.keepRunning()) {
+        simulation.fleet.beginStep(simulation.gravity, 60, nullptr);
+        simulation.fleet.endStep(simulation.gravity, 60, nullptr);
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range());
+}
+BENCHMARK(BM_FleetStep)->arg(1000)->arg(10000);
+
+// Broadphase and narrowphase for one hour-long step. Bodies just drift, so the
+// time is all collision detection.
+static void BM_CollisionDetect(bench::State& state) {
+    Simulation simulation;
+    seedScenario(simulation, static_cast<size_t>(state.range()));
+    BodyStore& bodies = simulation.bodies;
+    const double dt = 3600;
+    while (state.keepRunning()) {
+        simulation.collisions.beginStep(bodies, simulation.ship.get(), simulation.fleet);
+        for (size_t i = 0; i < bodies.size(); i++) {
+            bodies.x[i] += bodies.vx[i] * dt;
+            bodies.y[i] += bodies.vy[i] * dt;
+        }
+        simulation.collisions.detect(bodies, simulation.ship.get(), simulation.fleet);
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range());
+}
+BENCHMARK(BM_CollisionDetect)->arg(10000)->arg(100000);
+
+// A full prediction from scratch (what a burn costs the predictor each tick); the
+// arg is the body count, mostly too light to be part of the prediction
+static void BM_TrajectoryPredict(bench::State& state) {
+    Simulation simulation;
+    seedScenario(simulation, static_cast<size_t>(state.range()) - 1);
+    while (state.keepRunning()) {
+        Trajectory path = TrajectoryPredictor::predict(simulation, PREDICTION_HORIZON, PREDICTION_STEP);
+        bench::doNotOptimize(path);
+    }
+    state.setItemsProcessed(state.maxIterations() * static_cast<int64_t>(PREDICTION_HORIZON / PREDICTION_STEP));
+}
+BENCHMARK(BM_TrajectoryPredict)->arg(10)->arg(10000);
+
+// Dispersed ships flown for a month with a burn, on one thread; the arg is the ship count
+static void BM_Dispersion(bench::State& state) {
+    Simulation simulation;
+    seedScenario(simulation, 1000);
+    DispersionRunner runner;
+    runner.instances = static_cast<size_t>(state.range());
+    runner.duration = 30 * 86400;
+    runner.maneuver.start = 3600;
+    runner.maneuver.end = 3602;
+    runner.dispersion = Dispersion{1000, 0.1, 0.01, 0.01};
+    while (state.keepRunning()) {
+        runner.run(simulation, nullptr);
+        bench::doNotOptimize(runner.missDistance);
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range());
+}
+BENCHMARK(BM_Dispersion)->arg(256);
+
+// Single Lambert solves over a fixed set of random transfers around the Sun
+static void BM_LambertSolve(bench::State& state) {
+    const double mu = GRAVITATIONAL_CONSTANT * 1.989e30;
+    std::mt19937_64 rng(4242);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<Vector2D> from(1024), to(1024);
+    std::vector<double> tof(1024);
+    for (size_t k = 0; k < from.size(); k++) {
+        double a = unit(rng) * 2 * M_PI, b = unit(rng) * 2 * M_PI;
+        double r1 = 1e11 + unit(rng) * 2e12, r2 = 1e11 + unit(rng) * 2e12;
+        from[k] = Vector2D(r1 * std::cos(a), r1 * std::sin(a));
+        to[k] = Vector2D(r2 * std::cos(b), r2 * std::sin(b));
+        tof[k] = 86400 * (30 + unit(rng) * 2000);
+    }
+    size_t k = 0;
+    while (state.keepRunning()) {
+        Vector2D v1, v2;
+        Lambert::solve(from[k], to[k], tof[k], mu, true, v1, v2);
+        bench::doNotOptimize(v1);
+        k = (k + 1) & 1023;
+    }
+    state.setItemsProcessed(state.maxIterations());
+}
+BENCHMARK(BM_LambertSolve);
+
+// Porkchop grid from the default ship to the planet on every core; arg is the
+// grid size per axis, items are cells
+static void BM_PorkchopGrid(bench::State& state) {
+    Simulation simulation;
+    simulation.createDefaultScenario();
+    ThreadPool pool;
+    PorkchopPlot plot;
+    plot.setShip(simulation.bodies, simulation.ship->position, simulation.ship->velocity, 1, 0);
+    plot.defaultWindows(static_cast<size_t>(state.range()));
+    while (state.keepRunning()) {
+        plot.compute(&pool);
+        bench::doNotOptimize(plot.departureDeltaV.data());
+    }
+    state.setItemsProcessed(state.maxIterations() * state.range() * state.range());
+}
+BENCHMARK(BM_PorkchopGrid)->arg(256)->arg(1000);
+
+int main(int argc, char* argv[]) {
+    return bench::runAll(argc, argv);
+}
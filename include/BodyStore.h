@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "GravityKernel.h"
+#include "Utils.h"
+
+// Structure-of-arrays storage for celestial body physics state.
+// The integrators iterate these arrays directly; CelestialBody objects are
+// only handles into it for rendering.
+class BodyStore {
+public:
+    std::vector<double> x, y;   // Position in meters
+    std::vector<double> vx, vy; // Velocity in m/s
+    std::vector<double> mass;   // Mass in kg
+    std::vector<double> radius; // Physical radius in meters
+    std::vector<int32_t> parent; // Body this one rides around on Kepler rails, -1 for N-body motion
+
+    // Bumped whenever bodies are added or removed; anything holding indices
+    // across ticks compares it first
+    uint64_t layoutVersion = 0;
+
+    // Append a body and return its index
+    size_t add(double mass, double radius, Vector2D pos, Vector2D vel);
+
+    // Put body i on a Kepler orbit around an earlier body (parent < i), or -1 to release it.
+    // Returns false if the parent index is invalid.
+    bool setRailsParent(size_t i, int32_t parentIndex);
+
+    // Keep body i at newIndex[i], dropping it when that is -1. Kept bodies must
+    // stay in order; parents are moved as they are, so remap them first.
+    void compact(const std::vector<int32_t>& newIndex);
+
+    // Bodies with at least fraction of the heaviest body's mass, in index order;
+    // only the limit heaviest of them when there are more
+    void selectMassive(double fraction, size_t limit, std::vector<int32_t>& indices) const;
+
+    // Copy the bodies at indices (ascending) into out. Rails bodies whose parent
+    // is copied too stay on rails; the rest fly free.
+    void copySubset(const std::vector<int32_t>& indices, BodyStore& out) const;
+
+    void reserve(size_t count);
+
+    void clear();
+
+    size_t size() const { return x.size(); }
+
+    Vector2D position(size_t i) const { return Vector2D(x[i], y[i]); }
+    Vector2D velocity(size_t i) const { return Vector2D(vx[i], vy[i]); }
+
+    void setPosition(size_t i, const Vector2D& pos) { x[i] = pos.x; y[i] = pos.y; }
+    void setVelocity(size_t i, const Vector2D& vel) { vx[i] = vel.x; vy[i] = vel.y; }
+
+    // Sum of gravitational acceleration from every body at the given position
+    Vector2D accelerationAt(const Vector2D& pos, GravityKernel::Path path) const;
+};
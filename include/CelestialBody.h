@@ -1,20 +1,31 @@
 #pragma once
 #include "SpaceObject.h"
+#include "BodyStore.h"
+#include "CircleCache.h"
 
 // Class for planets, stars, etc.
+// Physics state lives in the BodyStore and is advanced by GravitySolver;
+// this is a rendering handle into it.
 class CelestialBody : public SpaceObject {
 public:
-    double radius; // Actual physical radius in meters
+    BodyStore* store;
+    size_t index;
     
-    CelestialBody(double mass, double radius, Vector2D pos, Vector2D vel, int renderSize);
+    CelestialBody(BodyStore& store, double mass, double radius, Vector2D pos, Vector2D vel, int renderSize);
+
+    // Handle for a body already in the store
+    CelestialBody(BodyStore& store, size_t index, int renderSize);
     
-    void update(const std::vector<std::shared_ptr<CelestialBody>>& bodies, double dt, bool RK4=true) override {
-        // Celestial bodies typically don't move in this simplified simulation
-        // but you could implement orbital motion for moons, etc.
-    }
+    Vector2D getPosition() const override { return store->position(index); }
+    Vector2D getVelocity() const { return store->velocity(index); }
+    double getMass() const { return store->mass[index]; }
+    double getRadius() const { return store->radius[index]; }
     
     // Calculate gravitational acceleration for other objects
     Vector2D calculateGravitationalAcceleration(const Vector2D& objectPosition) const;
     
-    void renderOrbit(SDL_Renderer* renderer, Vector2D cameraOffset);
-};
\ No newline at end of file
+    // Shade the gravitational influence around the body at the current zoom; position
+    // and radius come from the render snapshot, not the live store
+    void renderOrbit(SDL_Renderer* renderer, CircleCache& circles, Vector2D position, double bodyRadius,
+                     Vector2D cameraOffset, double scale);
+};
@@ -0,0 +1,24 @@
+#pragma once
+#include <SDL2/SDL.h>
+
+// Filled discs drawn from pre-rasterized textures, one per power-of-two
+// diameter bucket, stretched to the exact radius at draw time. Cost per disc
+// is one textured quad regardless of how large it is on screen.
+class CircleCache {
+public:
+    CircleCache();
+    ~CircleCache();
+
+    // Destroy the textures; call before the renderer that made them goes away
+    void clear();
+
+    // Draw a disc centered on a screen position
+    void drawDisc(SDL_Renderer* renderer, float centerX, float centerY, float radius, SDL_Color color);
+
+private:
+    static const int MIN_SHIFT = 3;  // 8 px diameter
+    static const int MAX_SHIFT = 10; // 1024 px diameter; larger discs are upscaled
+    SDL_Texture* textures[MAX_SHIFT - MIN_SHIFT + 1];
+
+    SDL_Texture* textureFor(SDL_Renderer* renderer, int shift);
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BodyStore.h"
+#include "ShipStore.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+
+class Spacecraft;
+
+// Two objects touching during a physics step
+struct Contact {
+    uint32_t a, b; // Object ids, a < b
+    double time;   // Fraction of the step at first touch, 0 if they started overlapping
+};
+
+// Collision detection across bodies, the player ship and the fleet.
+// Every object is a circle moving in a straight line from where it started the
+// step to where it ended, so a fast ship can't skip through a planet between
+// two samples. Broadphase: the swept boxes go into a SpatialHash sized from the
+// objects' typical extent, long sweeps cut into time slices; narrowphase: exact
+// first-touch time for each pair.
+//
+// Object ids: bodies first, then the ship (if any), then the fleet in packed order.
+class CollisionSystem {
+public:
+    enum class Kind : uint8_t { Body, Ship, Fleet };
+
+    std::vector<Contact> contacts; // From the last detect, by time, then ids
+
+    // Remember where every object starts the step
+    void beginStep(const BodyStore& bodies, const Spacecraft* ship, const ShipStore& fleet);
+
+    // Find contacts between the start positions and the current ones
+    void detect(const BodyStore& bodies, const Spacecraft* ship, const ShipStore& fleet, ThreadPool* pool = nullptr);
+
+    // What an id refers to, for the layout of the last detect
+    Kind kindOf(uint32_t id) const;
+    uint32_t indexOf(uint32_t id) const; // Into bodies or the fleet; 0 for the ship
+
+    // Start position of an id in the last step
+    Vector2D startOf(uint32_t id) const { return Vector2D(startX[id], startY[id]); }
+
+    size_t objectCount() const { return startX.size(); }
+
+private:
+    SpatialHash grid;
+    std::vector<double> startX, startY;
+    std::vector<double> endX, endY, radius;
+    std::vector<double> extents;       // Scratch for sizing the grid
+    std::vector<uint32_t> sliceOwner;  // Object behind each grid id past the objects
+    uint32_t gridIds = 0;              // Grid ids in use after the last detect
+    std::vector<std::vector<Contact>> taskContacts;
+
+    // Layout the grid was built for; ids change meaning when it changes
+    size_t bodyCount = 0;
+    bool hasShip = false;
+    uint64_t bodyLayout = UINT64_MAX;
+    uint64_t fleetLayout = UINT64_MAX;
+    int stepsSinceSizing = 0;
+
+    void resizeGrid(bool force);
+};
@@ -1,9 +1,29 @@
+#pragma once
+#include <cstdint>
 // Constants
 const int SCREEN_WIDTH = 1280;
 const int SCREEN_HEIGHT = 720;
 const double GRAVITATIONAL_CONSTANT = 6.67430e-11;
+const double MAX_THETA = 1.0; // Wider Barnes-Hut opening angles accept cells containing the body being pulled
+const double FUEL_PER_THRUST = 0.01; // Fuel burned per second per newton of engine power
 const double TIME_STEP = 1; // Simulation time step in seconds
 const double SCALE_FACTOR = 1e-9; // Scale for rendering orbital distances
 const double MIN_SCALE_FACTOR = 1e-13; // Zoomed all the way out
 const double MAX_SCALE_FACTOR = 1e-4; // Zoomed all the way in
-const double ZOOM_SPEED = 1.2; // How quickly zoom changes per scroll
\ No newline at end of file
+const double ZOOM_SPEED = 1.2; // How quickly zoom changes per scroll
+const double SIM_TICK_RATE = 60; // Simulation ticks per second, independent of the frame rate
+const int TRAIL_CAPACITY = 100000; // Max points kept in a ship's orbit trail
+const double TRAIL_PIXEL_SPACING = 2; // Min on-screen distance between recorded trail points
+const double TRAIL_MAX_INTERVAL = 86400; // Record a trail point at least this often (simulated seconds)
+const char* const QUICKSAVE_PATH = "quicksave.sim"; // F5 saves here, F9 loads it
+const char* const DEFAULT_SCENARIO_PATH = "scenarios/default.scn"; // Game start without --scenario or --load
+const uint64_t INPUT_DELAY_TICKS = 2; // Deterministic mode schedules input this many ticks ahead
+const uint64_t REPLAY_KEYFRAME_TICKS = 1800; // Keyframe every 30 s of recording; bounds the cost of a seek
+const uint64_t REPLAY_SEEK_TICKS = 600; // Arrow keys seek a replay by 10 s
+const double LAUNCH_SPEED = 50; // m/s a fleet ship launched from the player's ship leaves at
+const double SHIP_COLLISION_RADIUS = 20; // Meters, for the player's ship and fleet ships alike
+const double PREDICTION_HORIZON = 31557600; // Seconds of coasting the trajectory predictor looks ahead (one year)
+const double PREDICTION_STEP = 3600; // Seconds between predicted trajectory points
+const double PREDICTION_MASS_FRACTION = 1e-9; // Ship-only propagation leaves out bodies lighter than this share of the heaviest
+const int PREDICTION_MAX_BODIES = 64; // Heaviest bodies kept by ship-only propagation beyond that
+const int PORKCHOP_VIEW_GRID = 256; // Departure and arrival times per axis of the in-game porkchop plot
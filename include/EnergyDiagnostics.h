@@ -0,0 +1,31 @@
+#pragma once
+#include "BodyStore.h"
+#include "Utils.h"
+
+// Quantities an exact integrator would conserve
+struct ConservedQuantities {
+    double energy = 0;
+    double angularMomentum = 0;
+};
+
+// Relative drift of conserved quantities from a baseline sample
+class DriftTracker {
+public:
+    bool hasBaseline = false;
+    ConservedQuantities baseline;
+    ConservedQuantities latest;
+
+    // Next record() becomes the new baseline (e.g. after thrust or an integrator change)
+    void reset() { hasBaseline = false; }
+
+    void record(const ConservedQuantities& sample);
+
+    double energyDrift() const;          // |E - E0| / |E0|
+    double angularMomentumDrift() const; // |L - L0| / |L0|
+
+    // Kinetic plus pairwise potential energy and angular momentum about the origin, O(N^2)
+    static ConservedQuantities measureBodies(const BodyStore& bodies);
+
+    // Specific orbital energy and angular momentum relative to the body pulling hardest
+    static ConservedQuantities measureOrbit(const BodyStore& bodies, const Vector2D& position, const Vector2D& velocity);
+};
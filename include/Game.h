@@ -1,34 +1,116 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
-#include "SpaceCraft.h"
+#include "Simulation.h"
+#include "SpacecraftView.h"
 #include "CelestialBody.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "SimSnapshot.h"
+#include "LineBatch.h"
+#include "ViewCuller.h"
+#include "ResourceManager.h"
+#include "SpriteBatch.h"
+#include "PerfOverlay.h"
+#include "Replay.h"
+#include "TrajectoryPredictor.h"
+#include "PorkchopView.h"
+#include "Constants.h"
 #include "Utils.h"
 
-// Game class to manage the simulation
+// SDL front end for a Simulation.
+// Physics runs on its own thread at SIM_TICK_RATE; the render thread only sees
+// published snapshots and talks back through a command queue.
 class Game {
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
-    bool running;
+    std::atomic<bool> running;
     
-    std::vector<std::shared_ptr<CelestialBody>> celestialBodies;
-    std::shared_ptr<Spacecraft> playerShip;
+    Simulation simulation; // Owned by the simulation thread while it runs
+    std::vector<std::shared_ptr<CelestialBody>> celestialBodies; // Render handles into simulation.bodies
+    std::shared_ptr<SpacecraftView> playerShip;
     
     Vector2D cameraOffset;
     Vector2D mousePosition;
     bool followPlayerShip;
 
     double scaleFac;
+    LineBatch lineBatch; // Trails for the current frame, drawn in one call
+    CircleCache circleCache; // Influence discs, one texture per size bucket
+    ResourceManager resources; // Every sprite, packed into one atlas
+    SpriteBatch spriteBatch;   // This frame's sprites, drawn in one call
+    SpriteHandle asteroidSprite; // Drawn for bodies without a handle of their own
 
-    double timeWarpFactor = 1000;  // Normal speed by default
+    // Render-side culling; bodies with a handle are pinned and drawn with their own
+    // sprite, the rest as asteroids
+    ViewCuller viewCuller;
+    std::vector<CelestialBody*> bodyHandles; // By BodyStore index, null for bulk bodies
+    std::vector<uint8_t> pinnedBodies;
+    uint64_t handleLayout = 0;     // Body layout the handles are indexed for
+    uint64_t handleBase = 0;       // Layout they were created in
+    std::vector<size_t> handleBaseIndex; // Per celestialBodies entry, its index in handleBase
+    int maxSpriteSize = 0;         // Pixels
+    double influenceMargin = 0;    // World distance the influence disc reaches past a body
+    std::vector<double> renderX, renderY; // Interpolated body positions this frame
+    std::vector<SDL_FPoint> bodyPoints;
+
+    // Fleet ships: culled and clustered like bulk bodies, drawn with one shared sprite
+    ViewCuller fleetCuller;
+    SpriteHandle fleetSprite;
+    std::vector<double> fleetRenderX, fleetRenderY; // Interpolated fleet positions this frame
+    PerfOverlay perfOverlay; // F3 toggles it, F4 writes a trace
+
+    // Coasting path ahead of the player's ship, predicted off both main threads
+    TrajectoryPredictor predictor;
+    std::atomic<bool> showPrediction{true}; // P toggles it; hidden, the simulation stops feeding it
+
+    // Porkchop plot of transfers from the ship's orbit to a named body; H cycles the target
+    PorkchopView porkchopView;
+    std::vector<int32_t> porkchopTargets;    // Named bodies that orbit something heavier
+    std::atomic<int32_t> porkchopTarget{-1}; // Body to plot, -1 hides it (render thread writes)
+    int32_t porkchopStarted = -1;            // Target of the last plot handed over (simulation thread)
+
+    double requestedWarp = 1000;   // Last warp sent by the input side
     const double MIN_WARP = 1;  //  slow motion
     const double MAX_WARP = 100000000; // fast forward
 
-    const double MAX_PHYSICS_STEPS_PER_FRAME = 100; // Cap for performance
-    const double MAX_TIME_STEP = 3600.0; // Max step size in seconds (1 hour)
+    std::thread simulationThread;
+    TripleBuffer<SimSnapshot> snapshots; // Simulation -> render
+    SpscQueue<SimCommand> commands;      // Render -> simulation
+    std::chrono::steady_clock::time_point startTime;
+    bool deterministic = false; // Commands are stamped INPUT_DELAY_TICKS ahead
+
+    // Simulation thread
+    void simulationLoop();
+    void beginSnapshot();   // Capture start-of-tick positions
+    void publishSnapshot(); // Capture end-of-tick state and hand it to the renderer
+
+    // Render thread
+    void sendCommand(SimCommand command);
+    double wallSeconds() const;
+    void startSimulation();
+    void stopSimulation();
+    void seekReplay(uint64_t tick); // Render thread; pauses the simulation while it re-simulates
+    void writeTrace(); // Profiler ring as trace.json
+    void createRenderHandles(); // Views for whatever bodies and ship the simulation holds
+    void remapRenderHandles(const SimSnapshot& snapshot); // Follow merges without pausing the simulation
+
+    std::string startStatePath; // Loaded instead of a scenario when set
+    std::string scenarioPath = DEFAULT_SCENARIO_PATH;
+
+    // Session recording and playback; a replay ignores input that would change the physics
+    ReplayRecorder recorder;
+    std::string recordPath;
+    ReplayPlayer replay;
+    std::string replayPath;
+    bool replaying = false;
     
 public:
     Game();
@@ -37,18 +119,33 @@ public:
     
     bool init();
     
+    // Start from a saved state file instead of the default scenario
+    void setStartState(const std::string& path) { startStatePath = path; }
+
+    // Scenario file to build the system from (scenarios/default.scn otherwise)
+    void setScenario(const std::string& path) { scenarioPath = path; }
+
+    // Record every input with its tick, plus periodic keyframes, to path
+    void setRecording(const std::string& path) { recordPath = path; }
+
+    // Play a recording instead of taking input; arrow keys seek
+    void setReplay(const std::string& path) { replayPath = path; }
+
     void createGameObjects();
+
+    // Replace the running simulation with a saved state
+    void loadState(const std::string& path);
     
     void handleEvents();
 
     void zoomAt(double factor, Vector2D targetPos);
-    
-    void update();
 
-    void updatePhysics(double dt);
+    // Worker threads used for physics; 0 = all hardware threads, 1 = single-threaded
+    void setPhysicsThreads(unsigned threadCount);
+
+    // Reproducible physics and tick-stamped input; call before init()
+    void setDeterministic(bool enabled);
 
-    // void updatePhysicsRK4(double dt);
-    
     void render();
     
     void renderUI();
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "BodyStore.h"
+#include "GravityKernel.h"
+#include "QuadTree.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+
+// Mutual gravity between all bodies in a BodyStore, plus field evaluation for ships.
+// BarnesHut walks a quadtree rebuilt every step; Exact is the O(N^2) reference sum.
+class GravitySolver {
+public:
+    enum class Mode { Exact, BarnesHut };
+
+    explicit GravitySolver(BodyStore& bodies);
+
+    const BodyStore& bodies() const { return *store; }
+
+    Mode getMode() const { return mode; }
+    void setMode(Mode newMode);
+
+    double getTheta() const { return theta; }
+    // Clamped to [0, MAX_THETA]; getTheta() reports what was applied
+    void setTheta(double openingAngle);
+
+    // Kernel path for every sum this solver makes; starts as the process default.
+    // Unsupported paths fall back to the best available.
+    GravityKernel::Path getKernelPath() const { return kernelPath; }
+    void setKernelPath(GravityKernel::Path path);
+
+    // Body accelerations are split across this pool; null runs them serially.
+    // Each body's sum is computed by one thread in a fixed order, so results
+    // are bit-identical for any thread count.
+    void setThreadPool(ThreadPool* pool) { threadPool = pool; }
+
+    // Call after bodies were added or moved outside stepBodies
+    void invalidate();
+
+    // Rebuild the tree if body positions changed since the last build
+    void prepare();
+
+    // Gravitational acceleration at an arbitrary point, e.g. a spacecraft; requires prepare()
+    Vector2D accelerationAt(const Vector2D& pos) const;
+
+    // Advance every body by dt under mutual gravity (kick-drift-kick leapfrog).
+    // Bodies with a rails parent follow a closed-form Kepler orbit around it instead.
+    void stepBodies(double dt);
+
+    // Relative error of Barnes-Hut body accelerations against the exact sum
+    void measureError(double& maxRelError, double& rmsRelError);
+
+    // Body accelerations at the current positions, valid after prepare() or stepBodies()
+    std::vector<double> ax, ay;
+
+private:
+    BodyStore* store;
+    QuadTree tree;
+    ThreadPool* threadPool;
+    Mode mode;
+    double theta;
+    GravityKernel::Path kernelPath;
+    bool treeValid;
+    bool accelerationsValid;
+
+    // Rails bodies and their state relative to the parent, reused between steps
+    std::vector<size_t> railsBodies;
+    std::vector<Vector2D> railsPosition, railsVelocity;
+
+    void computeBodyAccelerations(Mode useMode, std::vector<double>& outX, std::vector<double>& outY);
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+// Vectorized inverse-square sum over contiguous source arrays.
+// The widest instruction set the CPU supports is the process default; each
+// GravitySolver takes the default when created and can be given its own path.
+class GravityKernel {
+public:
+    enum class Path { Scalar, SSE2, AVX2, AVX512 };
+
+    // Adds sum(mass * d / |d|^3) over n sources to ax, ay (G is not applied).
+    // Sources whose radius contains the target, or that sit on it, contribute nothing.
+    static void accumulate(const double* x, const double* y, const double* mass, const double* radius,
+                           size_t n, double tx, double ty, double& ax, double& ay);
+
+    // The same sum on a given path, which must be supported
+    static void accumulate(Path path, const double* x, const double* y, const double* mass, const double* radius,
+                           size_t n, double tx, double ty, double& ax, double& ay);
+
+    // Process default
+    static Path activePath();
+
+    // Force the process default, e.g. for benchmarking; unsupported paths fall
+    // back to the best available. Solvers created earlier keep their path.
+    static void setPath(Path path);
+
+    // Widest path this CPU supports
+    static Path bestPath();
+
+    static bool isSupported(Path path);
+
+    static const char* pathName(Path path);
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include "Utils.h"
+
+// Acceleration at a position (gravity plus any thrust)
+typedef std::function<Vector2D(const Vector2D&)> AccelerationFunction;
+
+enum class IntegratorType { Euler, RK4, DormandPrince45, Leapfrog, Yoshida4 };
+
+// Advances a point mass through an acceleration field.
+// Instances may keep per-object state (e.g. the adaptive step size).
+class Integrator {
+public:
+    static const int MAX_SUBSTEPS = 100000; // Per advance() call
+
+    virtual ~Integrator() {}
+
+    virtual IntegratorType type() const = 0;
+
+    // Advance position and velocity by exactly dt seconds
+    virtual void advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) = 0;
+
+    virtual std::unique_ptr<Integrator> clone() const = 0;
+
+    static std::unique_ptr<Integrator> create(IntegratorType type);
+
+    static const char* name(IntegratorType type);
+
+    // Inverse of name(); false for an unknown name
+    static bool fromName(const char* name, IntegratorType& type);
+};
+
+// Base for integrators that split dt into equal substeps of at most maxStep
+class FixedStepIntegrator : public Integrator {
+public:
+    double maxStep = 10.0; // Seconds
+
+    void advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) override;
+
+protected:
+    virtual void step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) = 0;
+};
+
+// Explicit Euler, one evaluation per step (first order)
+class EulerIntegrator : public FixedStepIntegrator {
+public:
+    IntegratorType type() const override { return IntegratorType::Euler; }
+    std::unique_ptr<Integrator> clone() const override;
+protected:
+    void step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) override;
+};
+
+// Classic Runge-Kutta, four evaluations per step
+class RK4Integrator : public FixedStepIntegrator {
+public:
+    IntegratorType type() const override { return IntegratorType::RK4; }
+    std::unique_ptr<Integrator> clone() const override;
+protected:
+    void step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) override;
+};
+
+// Velocity Verlet (kick-drift-kick leapfrog): symplectic, second order,
+// one evaluation per step since the closing kick's force opens the next step
+class LeapfrogIntegrator : public FixedStepIntegrator {
+public:
+    IntegratorType type() const override { return IntegratorType::Leapfrog; }
+    std::unique_ptr<Integrator> clone() const override;
+    void advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) override;
+protected:
+    void step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) override;
+private:
+    Vector2D cachedAcceleration; // Force at the current position, valid within one advance()
+};
+
+// Yoshida's 4th order composition of leapfrog: symplectic, three evaluations per step
+class Yoshida4Integrator : public FixedStepIntegrator {
+public:
+    IntegratorType type() const override { return IntegratorType::Yoshida4; }
+    std::unique_ptr<Integrator> clone() const override;
+protected:
+    void step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) override;
+};
+
+// Dormand-Prince 5(4) with embedded error control and per-object step size
+class DormandPrinceIntegrator : public Integrator {
+public:
+    double errorTolerance = 1e-10; // Relative error allowed per substep
+    double currentStep = 1.0;      // Last step size the controller settled on
+
+    IntegratorType type() const override { return IntegratorType::DormandPrince45; }
+    std::unique_ptr<Integrator> clone() const override;
+    void advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) override;
+};
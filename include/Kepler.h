@@ -0,0 +1,14 @@
+#pragma once
+#include "Utils.h"
+
+// Closed-form two-body propagation in universal variables (any conic section)
+class Kepler {
+public:
+    // Advance a state relative to a point mass with gravitational parameter mu
+    // by dt seconds. Returns false (state untouched) if the solver fails.
+    static bool propagate(Vector2D& position, Vector2D& velocity, double mu, double dt);
+
+    // Stumpff functions C(z) and S(z)
+    static double stumpffC(double z);
+    static double stumpffS(double z);
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include "Utils.h"
+
+// Lambert's problem: the conic from r1 to r2 in a given time around a point
+// mass. Izzo's method (2015): a Householder iteration on one variable whose
+// time-of-flight curve is smooth enough that 2-3 steps converge from the
+// initial guess, which is what makes dense transfer grids affordable.
+class Lambert {
+public:
+    // Velocities at both ends of the zero-revolution transfer taking tof seconds
+    // around a point mass with gravitational parameter mu, counterclockwise or not
+    // (the short or the long way round, whichever that is). Returns false for
+    // tof <= 0, a position at the center or if the iteration fails.
+    static bool solve(const Vector2D& r1, const Vector2D& r2, double tof, double mu, bool counterclockwise,
+                      Vector2D& v1, Vector2D& v2);
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+#include "Utils.h"
+
+// Collects world-space polylines for one frame and draws them all in a single
+// SDL_RenderGeometry call as thin quads with per-vertex color. Buffers are kept
+// between frames so steady-state drawing does not allocate.
+class LineBatch {
+public:
+    LineBatch();
+
+    void begin();
+
+    // Add a polyline. Every point is transformed to screen space once; points
+    // less than a pixel from the last kept one are dropped and segments entirely
+    // off screen are skipped. Alpha ramps from fadeAlpha at the first point to
+    // color.a at the last (pass fadeAlpha = color.a for a solid line).
+    void addPolyline(const Vector2D* points, size_t count, Vector2D cameraOffset, double scale,
+                     SDL_Color color, Uint8 fadeAlpha, float thickness);
+
+    // Polyline already in screen space (e.g. a cached shape placed by the caller)
+    void addScreenPolyline(const SDL_FPoint* points, size_t count, SDL_Color color, Uint8 fadeAlpha, float thickness);
+
+    // Submit everything added since begin(). Falls back to one SDL_RenderDrawLinesF
+    // per polyline if the renderer can't draw geometry.
+    void flush(SDL_Renderer* renderer);
+
+private:
+    struct Range {
+        size_t first, count;
+        SDL_Color color;
+    };
+
+    std::vector<SDL_FPoint> screen;  // Kept points of every polyline, back to back
+    std::vector<Uint8> alpha;        // Per kept point
+    std::vector<Range> ranges;       // One per polyline
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    bool geometrySupported;
+
+    void appendPoint(float x, float y, size_t& kept);
+    void buildGeometry(const Range& range, float thickness);
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "BodyStore.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+
+class Simulation;
+class Spacecraft;
+
+// Standard deviations of the errors drawn for every dispersed ship
+struct Dispersion {
+    double position = 0; // Meters, per axis
+    double velocity = 0; // m/s, per axis
+    double thrust = 0;   // Engine power, relative
+    double pointing = 0; // Thrust direction, radians
+};
+
+// One burn, in seconds from the start of the run
+struct Maneuver {
+    double start = 0, end = 0;
+    Vector2D direction = Vector2D(0, -1);
+};
+
+// Spread of one result over every dispersed ship
+struct DispersionStats {
+    double mean = 0, stddev = 0;
+    double min = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+// Monte Carlo dispersion of a maneuver: the player's ship is cloned into many
+// copies with seeded errors in its starting state and its burn, and each copy
+// flies exactly as the simulation would fly it. The massive bodies are stepped
+// once and recorded at every step; batches of ships then run in parallel
+// against that shared, read-only ephemeris. Only the miss distance and fuel
+// used of each ship are kept, never its path.
+class DispersionRunner {
+public:
+    size_t instances = 1000;
+    // Same seed, same ships and results on any thread count. The errors come from
+    // std::normal_distribution, whose output differs between standard libraries,
+    // so runs only repeat exactly with the same one.
+    uint64_t seed = 1;
+    double duration = 0;   // Seconds each ship flies
+    double maxStep = 3600; // Steps are equal parts of this or less, split at the burn's ends
+    Dispersion dispersion;
+    Maneuver maneuver;
+
+    // Miss distance is the closest approach to this body, or with -1 the
+    // distance from where the unperturbed ship ends up
+    int32_t target = -1;
+
+    // Called after every finished batch (one call at a time) with the ships done
+    // so far and the running mean and standard deviation of their miss distance
+    std::function<void(size_t done, double missMean, double missStddev)> progress;
+
+    // Results of the last run
+    double nominalMiss = 0, nominalFuel = 0; // The unperturbed ship
+    Vector2D nominalEnd;
+    DispersionStats missDistance, fuelUsed;
+
+    // False without a ship, steps or a valid target
+    bool run(const Simulation& simulation, ThreadPool* pool);
+
+    // The last run's results as JSON
+    void writeJson(std::ostream& out) const;
+
+private:
+    // Steps, and whether the burn covers each
+    std::vector<double> steps;
+    std::vector<uint8_t> burning;
+
+    // The massive bodies (and the target) at the start, and their states at
+    // every step boundary, boundary-major
+    BodyStore bodies;
+    int32_t targetIndex = -1;
+    std::vector<double> ephemerisX, ephemerisY, ephemerisVx, ephemerisVy;
+
+    // Per ship results, by instance
+    std::vector<double> miss, fuel;
+
+    void record(const BodyStore& state);
+    void load(size_t boundary, BodyStore& state) const;
+
+    // Fly ships first .. first + count - 1 from the simulation's ship (unperturbed
+    // copies with perturb false) into miss and fuel; returns where the last ended up
+    Vector2D fly(const Spacecraft& ship, size_t first, size_t count, bool perturb);
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+#include "RingBuffer.h"
+#include "SimSnapshot.h"
+
+// In-game performance panel: frame-time graph, physics steps per tick, body
+// count, achieved vs requested warp and the costliest profiled scopes
+class PerfOverlay {
+public:
+    bool visible;
+
+    PerfOverlay();
+
+    // Wall time since the previous frame started
+    void recordFrame(double frameMs);
+
+    // requestedRatio is the requested simulated seconds per wall second
+    void render(SDL_Renderer* renderer, const SimSnapshot& snapshot, double requestedRatio);
+
+private:
+    struct ScopeCost {
+        const char* name;
+        double msPerSecond; // Time spent in the scope per wall second
+    };
+
+    RingBuffer<float> frameTimes;
+    std::vector<SDL_Rect> rects; // Text and graph pixels, drawn in one call
+    std::vector<ProfileEvent> events;
+    std::vector<ScopeCost> scopes;
+    int framesSinceSummary;
+
+    // Achieved warp, measured over at least half a second of snapshots
+    double sampleSimTime, samplePublishTime, achievedRatio;
+
+    void summarizeScopes();
+    void drawText(int x, int y, const std::string& text, int pixel);
+};
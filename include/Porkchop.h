@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "BodyStore.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+
+// Transfer costs from one orbit to another over a grid of departure and arrival
+// times (a porkchop plot). Both orbits are two-body conics around one central
+// body, so every grid time costs one Kepler step per orbit, shared by its whole
+// row or column; each cell is then one Lambert arc.
+class PorkchopPlot {
+public:
+    // Orbits relative to the central body at the epoch
+    Vector2D departurePosition, departureVelocity;
+    Vector2D arrivalPosition, arrivalVelocity;
+    double mu = 0;        // Central body's G * M
+    double epoch = 0;     // Simulated seconds
+    int32_t central = -1; // Body index, when set from a BodyStore
+
+    // Row i departs at departureTime(i), column j arrives at arrivalTime(j); both
+    // windows include their ends
+    size_t departures = 0, arrivals = 0;
+    double departureStart = 0, departureEnd = 0;
+    double arrivalStart = 0, arrivalEnd = 0;
+
+    // Delta-v to leave the departure orbit and to match the arrival orbit, row by
+    // row; NaN where there is no transfer (arrival before departure)
+    std::vector<double> departureDeltaV, arrivalDeltaV;
+
+    // From body from to body to, around the heavier body pulling hardest on to.
+    // False if to has no heavier body or from is the central body.
+    bool setBodies(const BodyStore& bodies, size_t from, size_t to, double now);
+
+    // From a ship's current orbit (absolute state) to body to
+    bool setShip(const BodyStore& bodies, const Vector2D& position, const Vector2D& velocity, size_t to, double now);
+
+    // A size x size grid departing over one synodic period, with flight times
+    // from a quarter to twice the Hohmann transfer time
+    void defaultWindows(size_t size);
+
+    // Fill the grid; rows are shared across the pool (null computes serially)
+    void compute(ThreadPool* pool);
+
+    double departureTime(size_t i) const;
+    double arrivalTime(size_t j) const;
+
+    double totalDeltaV(size_t i, size_t j) const {
+        return departureDeltaV[i * arrivals + j] + arrivalDeltaV[i * arrivals + j];
+    }
+
+    // Cheapest cell by total delta-v; false if no cell has a transfer
+    bool cheapest(size_t& i, size_t& j) const;
+
+    // Total delta-v as CSV: arrival times across the top, one row per departure
+    void writeCsv(std::ostream& out) const;
+
+private:
+    // Orbit states at each grid time
+    std::vector<Vector2D> departureAt, departureVelocityAt;
+    std::vector<Vector2D> arrivalAt, arrivalVelocityAt;
+
+    bool setCentral(const BodyStore& bodies, size_t to);
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Porkchop.h"
+#include "ThreadPool.h"
+
+// In-game porkchop heatmap. The simulation thread hands over a plot with its
+// orbits and windows set, a background thread fills the grid on a pool of its
+// own and the render thread turns the finished grid into a texture. Departure
+// time runs left to right, arrival time bottom to top; bright is cheap, cells
+// without a transfer stay black and the cheapest cell is outlined.
+class PorkchopView {
+public:
+    PorkchopView();
+    ~PorkchopView();
+
+    // Simulation thread: fill this plot in the background, labelled with the body
+    // it goes to. False (and nothing starts) while the last one is still running.
+    bool compute(const PorkchopPlot& setup, int32_t target);
+
+    bool busy() const { return computing; }
+
+    // Render thread: draw the newest finished plot if it goes to target
+    void render(SDL_Renderer* renderer, int32_t target);
+
+    // Destroy the texture; call before the renderer that made it goes away
+    void clear();
+
+private:
+    ThreadPool pool;
+    std::thread worker;
+    std::atomic<bool> computing;
+    PorkchopPlot working; // Worker thread while computing
+    int32_t workingTarget;
+
+    std::mutex finishedMutex; // Guards the three below
+    PorkchopPlot finished;
+    int32_t finishedTarget;
+    bool fresh; // Finished since the texture was last filled
+
+    // Render thread
+    SDL_Texture* texture;
+    int textureWidth, textureHeight;
+    int32_t shownTarget;
+    std::vector<Uint32> pixels;
+    int cheapestX, cheapestY; // Texture cell, -1 if no transfer
+
+    void fillTexture(SDL_Renderer* renderer);
+};
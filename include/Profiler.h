@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// One timed scope
+struct ProfileEvent {
+    const char* name; // Must be a string literal (stored by pointer)
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint32_t thread; // Small per-process thread number
+};
+
+// Process-wide lock-free ring of timed scopes. Any thread may record; readers
+// copy out whatever complete events are still in the ring without blocking writers.
+class Profiler {
+public:
+    static const size_t CAPACITY = 1 << 16;
+
+    // Off by default, so scopes cost a relaxed load until a tool asks for timings
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    // Monotonic nanoseconds
+    static uint64_t now();
+
+    static void record(const char* name, uint64_t startNs, uint64_t durationNs);
+
+    // Events still in the ring, oldest first; events being overwritten are skipped
+    static void collect(std::vector<ProfileEvent>& out);
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto) of everything in the ring
+    static void writeChromeTrace(std::ostream& out);
+};
+
+// Records the enclosing scope's duration
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name) : name(name), start(Profiler::isEnabled() ? Profiler::now() : 0) {}
+    ~ScopedTimer() {
+        if (start) Profiler::record(name, start, Profiler::now() - start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ScopedTimer PROFILE_CONCAT(scopedTimer, __LINE__)(name)
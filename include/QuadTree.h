@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "GravityKernel.h"
+
+// Barnes-Hut quadtree over point masses.
+// Points are copied into tree order so every leaf is a contiguous range.
+class QuadTree {
+public:
+    static const int LEAF_CAPACITY = 8;
+    static const int MAX_DEPTH = 48; // Stops splitting coincident points forever
+
+    struct Node {
+        double centerX, centerY, halfSize; // Square bounds
+        double comX, comY, mass;           // Center of mass and total mass
+        int32_t firstChild;                // Index of 4 consecutive children, -1 for leaves
+        uint32_t first, count;             // Range of points in tree order
+    };
+
+    std::vector<Node> nodes;
+
+    // Point data in tree order
+    std::vector<double> px, py, pmass, pradius;
+    std::vector<uint32_t> order; // Tree order -> original index
+
+    // Rebuild the tree over n points; radius may be null
+    void build(const double* x, const double* y, const double* mass, const double* radius, size_t n);
+
+    bool empty() const { return nodes.empty(); }
+
+    // Sum of mass / r^2 acceleration (without G) at (tx, ty), using opening angle
+    // theta and the given kernel path
+    void accumulate(double tx, double ty, double theta, GravityKernel::Path path, double& ax, double& ay) const;
+
+    // Points inside the rectangle, as tree-order indices. Nodes holding several
+    // points but narrower than minNodeSize are reported whole in clusters instead.
+    void query(double minX, double minY, double maxX, double maxY, double minNodeSize,
+               std::vector<uint32_t>& points, std::vector<int32_t>& clusters) const;
+
+private:
+    // Partition scratch space, sized once per build
+    std::vector<uint8_t> quadrant;
+    std::vector<uint32_t> tmpOrder;
+    std::vector<double> tmpX, tmpY, tmpMass, tmpRadius;
+
+    void split(int32_t nodeIndex, int depth);
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "SimSnapshot.h"
+
+class Simulation;
+
+// A recorded session on disk: header, then chunks in tick order
+//   keyframe: StateFile bytes of the state at the start of a tick
+//   command:  one applied SimCommand stamped with its tick
+//   end:      final tick and stateHash, for verification
+// Keyframes are taken every keyframeInterval ticks, so seeking anywhere
+// re-simulates at most one interval from the nearest keyframe.
+class ReplayRecorder {
+public:
+    ReplayRecorder() = default;
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    // Writes the first keyframe and starts logging the simulation's commands
+    bool start(Simulation& simulation, const std::string& path, uint64_t keyframeInterval);
+
+    // Call before every runTick: flushes logged commands, takes a keyframe when due
+    void beforeTick(Simulation& simulation);
+
+    // Writes the end marker and stops logging
+    void finish(Simulation& simulation);
+
+    bool isRecording() const { return out.is_open(); }
+
+private:
+    std::ofstream out;
+    std::string path;
+    uint64_t keyframeInterval = 0;
+    uint64_t lastKeyframeTick = 0;
+    std::vector<SimCommand> log; // Commands applied since the last flush
+    std::vector<char> keyframeBytes;
+
+    void flushCommands();
+    void writeKeyframe(const Simulation& simulation);
+};
+
+class ReplayPlayer {
+public:
+    bool deterministic = false;
+    uint64_t keyframeInterval = 0;
+    uint64_t startTick = 0;
+    uint64_t endTick = 0;
+    uint64_t endHash = 0;           // 0 if the session didn't end cleanly
+    std::vector<SimCommand> commands; // In tick order
+
+    // Reads the command log and keyframe index; keyframe states stay on disk
+    bool load(const std::string& path);
+
+    // Bring the simulation to the start of tick target (clamped to the recording):
+    // restore the nearest keyframe at or before it, then re-run its commands
+    bool seek(Simulation& simulation, uint64_t target);
+
+    // Hash of the physical state (bodies and ship), equal for bit-identical runs
+    static uint64_t stateHash(const Simulation& simulation);
+
+private:
+    struct KeyframeEntry {
+        uint64_t tick;
+        uint64_t offset; // Of the StateFile bytes in the replay file
+        uint64_t size;
+    };
+
+    std::string path;
+    std::vector<KeyframeEntry> keyframes;
+    std::vector<char> keyframeBytes;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <map>
+#include <memory>
+#include <string>
+
+// Where a sprite sits in the atlas; updated in place when the atlas is repacked
+struct Sprite {
+    SDL_Rect region;
+};
+
+// Ref-counted; the sprite leaves the atlas at the next repack after the last handle goes
+typedef std::shared_ptr<const Sprite> SpriteHandle;
+
+// Loads each image once and packs every live sprite into a single atlas texture,
+// so any number of objects sharing a sprite costs one decode and one texture.
+class ResourceManager {
+public:
+    ResourceManager();
+    ~ResourceManager();
+
+    void setRenderer(SDL_Renderer* renderer);
+
+    // Sprite for an image file, decoded on first request; null if it can't be loaded
+    SpriteHandle sprite(const std::string& path);
+
+    // Generated lumpy grey rock, shared by every asteroid
+    SpriteHandle asteroidSprite();
+
+    // Atlas texture holding every live sprite; repacks first if sprites came or went
+    SDL_Texture* atlas();
+    int atlasWidth() const { return atlasW; }
+    int atlasHeight() const { return atlasH; }
+
+    size_t spriteCount() const { return entries.size(); }
+
+    // Free the atlas and all decoded images; call before destroying the renderer
+    void clear();
+
+private:
+    struct Entry {
+        SDL_Surface* surface; // RGBA32 copy kept for repacking
+        std::weak_ptr<Sprite> sprite;
+    };
+
+    std::map<std::string, Entry> entries;
+    SDL_Renderer* renderer;
+    SDL_Texture* atlasTexture;
+    int atlasW, atlasH;
+    bool dirty;
+
+    SpriteHandle addSurface(const std::string& key, SDL_Surface* surface);
+    void repack();
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity circular buffer; pushing when full overwrites the oldest element
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 0) : slots(capacity), start(0), count(0) {}
+
+    void push(const T& item) {
+        if (slots.empty()) return;
+        if (count < slots.size()) {
+            slots[(start + count) % slots.size()] = item;
+            count++;
+        } else {
+            slots[start] = item;
+            start = (start + 1) % slots.size();
+        }
+    }
+
+    // Element i counting from the oldest
+    const T& operator[](size_t i) const { return slots[(start + i) % slots.size()]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+    bool empty() const { return count == 0; }
+
+    void clear() {
+        start = 0;
+        count = 0;
+    }
+
+    // Resize storage, keeping the newest elements that still fit
+    void setCapacity(size_t capacity) {
+        std::vector<T> kept;
+        copyTo(kept);
+        if (kept.size() > capacity) kept.erase(kept.begin(), kept.end() - capacity);
+        slots.assign(capacity, T());
+        start = 0;
+        count = kept.size();
+        std::copy(kept.begin(), kept.end(), slots.begin());
+    }
+
+    // Linearize oldest-first into out, reusing its storage
+    void copyTo(std::vector<T>& out) const {
+        size_t firstRun = std::min(count, slots.size() - start);
+        out.assign(slots.begin() + start, slots.begin() + start + firstRun);
+        out.insert(out.end(), slots.begin(), slots.begin() + (count - firstRun));
+    }
+
+private:
+    std::vector<T> slots;
+    size_t start; // Index of the oldest element
+    size_t count;
+};
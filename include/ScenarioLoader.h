@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <string>
+
+class Simulation;
+
+// Procedural belt or ring: bodies on randomly perturbed orbits around a parent
+struct BeltSpec {
+    size_t parent = 0;      // Body index the belt orbits
+    size_t count = 0;
+    double innerRadius = 0; // Semi-major axis range in meters
+    double outerRadius = 0;
+    double minMass = 1e12, maxMass = 1e12;     // kg, log-uniform
+    double minRadius = 1000, maxRadius = 1000; // m, log-uniform
+    double maxEccentricity = 0;
+    uint64_t seed = 1;
+    bool rails = false;     // Ride Kepler orbits around the parent instead of N-body motion
+};
+
+// Fleet of ships on randomly perturbed orbits around a body
+struct FleetSpec {
+    size_t parent = 0;      // Body index the fleet orbits
+    size_t count = 0;
+    double innerRadius = 0; // Semi-major axis range in meters
+    double outerRadius = 0;
+    double minMass = 1000, maxMass = 1000; // kg, log-uniform
+    double maxEccentricity = 0;
+    double fuel = 0;
+    double thrust = 0;      // Engine thrust in newtons
+    int renderSize = 4;     // Pixels
+    uint64_t seed = 1;
+};
+
+// Builds a Simulation from a scenario file: one directive per line, then
+// key=value fields. '#' starts a comment. Units are kg, m, m/s and degrees.
+//
+//   settings warp=1000 gravity=barnes-hut theta=0.5 collisions=1
+//   body name=star mass=1.989e30 radius=6.96e8 sprite=assets/star.png size=60
+//   body name=moon mass=7e22 radius=1.7e6 around=planet distance=3.8e8 angle=90 rails=1
+//   ship mass=1000 fuel=1000 power=50000 x=1e13 y=0 vx=0 vy=1600 integrator=Leapfrog
+//   belt around=star count=200000 inner=3e11 outer=5e11 mass=1e12:1e18 radius=100:5e4 eccentricity=0.05 seed=7
+//   ring around=planet count=50000 inner=7e7 outer=1.4e8 mass=1e6:1e9 radius=1:50
+//   fleet around=star count=10000 inner=8e12 outer=1.2e13 mass=500:5000 fuel=100 thrust=2000 size=4
+//
+// A body or ship gives either x/y/vx/vy or a circular orbit around a named body.
+// Lines are parsed one at a time into the simulation, so memory stays bounded by
+// the bodies themselves however large the file.
+class ScenarioLoader {
+public:
+    // Replaces the simulation's contents; on error it is left empty
+    static bool load(Simulation& simulation, const std::string& path);
+    static bool parse(Simulation& simulation, std::istream& in, const std::string& sourceName);
+
+    // Appends spec.count bodies straight into the body store
+    static void generateBelt(Simulation& simulation, const BeltSpec& spec);
+
+    // Spawns spec.count ships into the simulation's fleet
+    static void generateFleet(Simulation& simulation, const FleetSpec& spec);
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Gravity.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+
+// Refers to a fleet ship across spawns and despawns. A despawned ship's slot is
+// reused with a new generation, so stale handles are detected instead of aliasing.
+struct ShipHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const ShipHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const ShipHandle& other) const { return !(*this == other); }
+};
+
+// Thousands of lightweight ships (the player keeps a full Spacecraft). Each
+// component is a packed array and entry i of every array is the same ship, so
+// systems stream through exactly the data they use. Despawning moves the last
+// ship into the hole, keeping the arrays packed; handles go through a slot
+// table with a free list, so spawn, despawn and lookup are all O(1).
+class ShipStore {
+public:
+    static const size_t TRAIL_POINTS = 32; // Per ship, newest replace oldest
+
+    // Kinematics; ax, ay is the gravity at x, y from the end of the last step (NaN until the first)
+    std::vector<double> x, y;
+    std::vector<double> vx, vy;
+    std::vector<double> ax, ay;
+
+    // Propulsion: engine thrust in newtons along a unit direction while burning
+    std::vector<double> mass;
+    std::vector<double> fuel;
+    std::vector<double> thrust;
+    std::vector<double> thrustX, thrustY;
+    std::vector<uint8_t> burning;
+
+    // Trails: TRAIL_POINTS (x, y) slots per ship, a ring starting at trailHead
+    std::vector<double> trailPoints;
+    std::vector<uint16_t> trailHead, trailCount;
+    std::vector<double> trailElapsed; // Seconds since the last recorded point
+    double trailInterval = 6 * 3600;  // Seconds between trail points
+
+    // Render: on-screen size in pixels
+    std::vector<uint8_t> renderSize;
+
+    // Slot of the ship stored at each packed index
+    std::vector<uint32_t> owner;
+
+    size_t size() const { return x.size(); }
+    void reserve(size_t count);
+    void clear();
+
+    ShipHandle spawn(double shipMass, Vector2D pos, Vector2D vel, double shipFuel, double shipThrust, uint8_t size = 4);
+
+    // False if the handle is stale
+    bool despawn(ShipHandle handle);
+
+    bool alive(ShipHandle handle) const;
+
+    // Packed index of a live ship, or -1
+    int64_t indexOf(ShipHandle handle) const;
+
+    // Handle of the ship at a packed index
+    ShipHandle handleAt(size_t index) const;
+
+    // Burn along direction until the engine is cut or the fuel runs out
+    void setBurn(ShipHandle handle, bool active, Vector2D direction = Vector2D());
+
+    // One kick-drift-kick leapfrog step of dt, split around the body step so
+    // ships and bodies advance in lockstep with one gravity evaluation per ship:
+    //   beginStep: half kick with the acceleration from the last step, full drift
+    //   endStep:   acceleration at the new position (after stepBodies), half kick, trail
+    // Burning ships add thrust to each half kick for as much of dt/2 as their fuel lasts.
+    // Both need the gravity tree prepared for the current body positions. Ships are
+    // split across the pool (null runs serially); each only touches its own entries,
+    // so results don't depend on the thread count.
+    void beginStep(const GravitySolver& gravity, double dt, ThreadPool* pool);
+    void endStep(const GravitySolver& gravity, double dt, ThreadPool* pool);
+
+    // Ring slot i (0 = oldest) of ship index's trail
+    Vector2D trailPoint(size_t index, size_t i) const;
+
+    // Slot table: index is the packed index while the slot is live, the next
+    // free slot while it is free. Public for StateFile.
+    struct Slot {
+        uint32_t index;
+        uint32_t generation;
+    };
+    std::vector<Slot> slots;
+    uint32_t freeHead = UINT32_MAX;
+
+    // Bumped by every spawn and despawn; renderers compare it before pairing
+    // packed indices across snapshots
+    uint64_t layoutVersion = 0;
+
+private:
+    // Move the last ship into index and drop the last entry
+    void moveLastTo(size_t index);
+    // Thrust kick of up to seconds, cut short when the fuel runs out; burns that fuel
+    void burn(size_t index, double seconds);
+    void forEachChunk(ThreadPool* pool, const std::function<void(size_t, size_t)>& body);
+};
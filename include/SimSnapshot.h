@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Utils.h"
+
+// Input from the render thread, applied by the simulation thread at the start of a tick.
+// Stamped with the tick it runs on, so a log of applied commands replays exactly.
+struct SimCommand {
+    enum class Type { Thrust, SetWarp, ToggleGravityMode, AdjustTheta, SetThreads, CycleIntegrator, ToggleDiagnostics,
+                      TogglePatchedConics, SetTrailSpacing, SaveState, LaunchShip };
+
+    Type type;
+    bool active;        // Thrust on/off
+    Vector2D direction; // Thrust or launch direction
+    double value;       // Warp factor, theta delta, thread count, trail spacing in meters or launch speed
+    uint64_t tick = 0;  // Tick to apply it on; earlier (or 0) means the next tick
+
+    // False for commands that only affect this session (saving, threads,
+    // diagnostics, trail spacing); replays neither record nor re-run those
+    bool changesPhysics() const {
+        return type != Type::SetThreads && type != Type::ToggleDiagnostics && type != Type::SetTrailSpacing &&
+               type != Type::SaveState;
+    }
+};
+
+// Spacecraft state at the end of a tick, plus its position at the start for interpolation
+struct ShipSnapshot {
+    Vector2D position;
+    Vector2D previousPosition;
+    Vector2D velocity;
+    Vector2D thrustDirection;
+    bool thrusting;
+    bool onRails; // Coasting on a Kepler orbit
+    double fuel;
+    std::vector<Vector2D> trail; // Oldest first; the renderer joins the last point to the ship
+    uint64_t trailVersion = 0;   // Skip re-copying an unchanged trail into a reused buffer
+};
+
+// Immutable copy of the simulation published once per tick for rendering
+struct SimSnapshot {
+    uint64_t tick = 0;
+    double simTime = 0;     // Simulated seconds since start
+    double publishTime = 0; // Wall clock seconds when published
+    double timeWarpFactor = 0;
+    int physicsSteps = 0; // Physics steps the tick took
+
+    // Body positions at the end and start of the tick. Indices only pair up
+    // across the two when the layouts match (no body merged during the tick).
+    std::vector<double> bodyX, bodyY;
+    std::vector<double> previousBodyX, previousBodyY;
+    std::vector<double> bodyRadius; // Only re-copied when the layout changes
+    uint64_t bodyLayout = 0, previousBodyLayout = 0;
+
+    // Where each body of layout bodyRemapBase sits in bodyLayout, -1 once merged
+    // away; bodyRemapBase is 0 when the bodies changed some other way
+    std::vector<int32_t> bodyRemap;
+    uint64_t bodyRemapBase = 0;
+
+    ShipSnapshot ship;
+
+    // Fleet positions at the end and start of the tick. Packed indices only pair
+    // up across the two when the layouts match (nothing spawned or despawned).
+    std::vector<double> fleetX, fleetY;
+    std::vector<double> previousFleetX, previousFleetY;
+    std::vector<uint8_t> fleetSize; // Pixels
+    uint64_t fleetLayout = 0, previousFleetLayout = 0;
+
+    // Relative drift of conserved quantities, when diagnostics are on
+    bool diagnosticsEnabled = false;
+    double shipEnergyDrift = 0, shipAngularMomentumDrift = 0;
+    double bodyEnergyDrift = 0, bodyAngularMomentumDrift = 0;
+};
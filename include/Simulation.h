@@ -0,0 +1,122 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BodyStore.h"
+#include "Gravity.h"
+#include "ThreadPool.h"
+#include "SpaceCraft.h"
+#include "ShipStore.h"
+#include "Collisions.h"
+#include "SimSnapshot.h"
+#include "EnergyDiagnostics.h"
+#include "StateFile.h"
+#include "Utils.h"
+
+// How a front end should draw a body; the physics never looks at it
+struct BodyInfo {
+    std::string sprite; // Image path, empty for bulk bodies drawn as asteroids
+    int renderSize;     // Sprite size in pixels
+};
+
+// Physics core: bodies, the player ship and everything that advances them.
+// Has no SDL dependency, so it runs the same in the game and headless.
+class Simulation {
+public:
+    BodyStore bodies;
+    std::vector<BodyInfo> bodyInfo; // Parallel to bodies
+    ThreadPool physicsPool; // Shares the per-substep force evaluation across cores
+    GravitySolver gravity;
+    std::shared_ptr<Spacecraft> ship;
+    ShipStore fleet; // Every other ship, stepped in bulk alongside the bodies
+
+    // Swept collisions after every physics step: bodies merge, the player's ship
+    // bounces off bodies and fleet ships are destroyed by anything they hit
+    CollisionSystem collisions;
+    bool collisionsEnabled = true;
+
+    double timeWarpFactor = 1000;  // Simulated seconds per tick = warp * TIME_STEP
+    const double MAX_PHYSICS_STEPS_PER_FRAME = 100; // Cap for performance
+    const double MAX_TIME_STEP = 3600.0; // Max step size in seconds (1 hour)
+
+    // Integrator drift diagnostics (ship per physics step, bodies per tick)
+    bool diagnosticsEnabled = false;
+    DriftTracker shipDrift;
+    DriftTracker bodyDrift;
+
+    StateWriter stateWriter; // Quicksaves are written off the simulation thread
+
+    // Deterministic mode: one fixed gravity kernel path so results don't depend on
+    // the CPU's vector width; with the strict-FP build and tick-stamped commands,
+    // identical inputs give bit-identical runs
+    bool deterministic = false;
+
+    // Commands waiting for their tick, in (tick, arrival) order
+    std::vector<SimCommand> pendingCommands;
+    // When set, every applied command that changes physics is appended here stamped with its tick
+    std::vector<SimCommand>* commandLog = nullptr;
+
+    // Where each body of layout bodyRemapBase sits now (-1 once merged away),
+    // composed over every merge since; the renderer moves its handles with it
+    // instead of pausing the simulation to rebuild them
+    std::vector<int32_t> bodyRemap;
+    uint64_t bodyRemapBase = 0;
+    uint64_t bodyRemapLayout = 0; // Layout the remap leads to; stale if the bodies changed any other way
+
+    uint64_t tick = 0;   // Ticks run so far
+    int lastTickSteps = 0; // Physics steps taken by the last tick
+    double simTime = 0;  // Simulated seconds so far
+
+    Simulation();
+
+    size_t addBody(double mass, double radius, Vector2D pos, Vector2D vel, const std::string& sprite = "", int renderSize = 0);
+
+    // Star, planet and player ship
+    void createDefaultScenario();
+
+    // The player ship on its default starting orbit
+    void createDefaultShip();
+
+    // One tick: due commands, then warp * TIME_STEP simulated seconds split into physics steps
+    void runTick();
+
+    // Exactly seconds of simulated time in steps of at most maxStep, as fast as possible
+    void advance(double seconds, double maxStep);
+
+    // A single physics step for the ship, the fleet and every body
+    void updatePhysics(double dt);
+
+    // Apply the contacts found over the last physics step
+    void resolveCollisions();
+
+    // Drop bodies, keeping the order of the rest. replacement[i] is i for a body
+    // that stays, else the body it merged into (or -1); rails bodies whose parent
+    // went follow that body if it comes earlier in the store, else fly free.
+    void removeBodies(const std::vector<int32_t>& replacement);
+
+    // Start bodyRemap over from the current layout
+    void resetBodyRemap();
+
+    // Schedule a command for its tick; runTick applies it
+    void queueCommand(const SimCommand& command);
+
+    // Apply queued commands that are due at the current tick
+    void applyDueCommands();
+
+    void applyCommand(const SimCommand& command);
+
+    void setDeterministic(bool enabled);
+
+    // Worker threads used for physics; 0 = all hardware threads, 1 = single-threaded
+    void setPhysicsThreads(unsigned threadCount);
+
+    // Start-of-tick positions, then end-of-tick state, for render interpolation
+    void beginSnapshot(SimSnapshot& snapshot) const;
+    void fillSnapshot(SimSnapshot& snapshot) const;
+
+    // Current state as JSON
+    void writeState(std::ostream& out) const;
+};
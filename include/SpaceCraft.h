@@ -1,26 +1,72 @@
 #pragma once
-#include "SpaceObject.h"
+#include <memory>
+#include <vector>
+#include "Gravity.h"
+#include "SimSnapshot.h"
+#include "Integrator.h"
+#include "RingBuffer.h"
+#include "Utils.h"
 
-// Class for player spacecraft
-class Spacecraft : public SpaceObject {
+// Physics state of the player spacecraft (drawn by SpacecraftView)
+class Spacecraft {
 public:
+    Vector2D position;
+    Vector2D velocity;
+    double mass;
     double fuel;
     double enginePower;
     bool thrustActive;
     Vector2D thrustDirection;
-    std::vector<Vector2D> orbitTrail;
+
+    // Decimated trail: a point is kept once the ship has moved trailMinDistance
+    // or trailMaxInterval simulated seconds have passed since the last one
+    RingBuffer<Vector2D> orbitTrail;
+    double trailMinDistance; // Meters
+    double trailMaxInterval; // Seconds
+    double trailElapsed;     // Seconds since the last recorded point
+    uint64_t trailVersion;   // Bumped whenever a point is recorded
+
+    std::unique_ptr<Integrator> integrator; // Dormand-Prince 5(4) by default
+
+    // Patched conics: a coasting ship inside one dominant well follows a Kepler orbit
+    bool patchedConics;
+    double soiThreshold; // Max tidal perturbation, relative to the primary's pull
+    bool onRails;        // Last step was closed-form
     
-    Spacecraft(double mass, Vector2D pos, Vector2D vel, double fuel, double enginePower, int size);
+    Spacecraft(double mass, Vector2D pos, Vector2D vel, double fuel, double enginePower);
+
+    void setIntegrator(IntegratorType type);
+
+    // Trail length in points; keeps the newest points that fit
+    void setTrailCapacity(size_t points);
     
-    void update(const std::vector<std::shared_ptr<CelestialBody>>& bodies, double dt, bool RK4=true) override;
+    // Advance by exactly dt seconds
+    void update(const GravitySolver& gravity, double dt);
     
-    Vector2D calculateAcceleration(const std::vector<std::shared_ptr<CelestialBody>>& bodies, const Vector2D& pos);
+    // Body to coast around on Kepler rails this step, or -1 to integrate numerically.
+    // Requires gravity.prepare() for the current body positions.
+    int coastingPrimary(const GravitySolver& gravity) const;
+
+    // Closed-form step around primary, given the state relative to it before the
+    // bodies moved; call after the bodies were stepped
+    void coast(const GravitySolver& gravity, size_t primary, Vector2D relativePosition, Vector2D relativeVelocity, double dt);
+    
+    Vector2D getPosition() const { return position; }
+    
+    Vector2D calculateAcceleration(const GravitySolver& gravity, const Vector2D& pos) const;
 
     void applyThrust(bool active);
     
     void setThrustDirection(const Vector2D& direction);
     
-    void renderTrail(SDL_Renderer* renderer, Vector2D cameraOffset, double scale);
-    
-    void render(SDL_Renderer* renderer, Vector2D cameraOffset, double scale) override;
+    // Copy the state the renderer needs into a snapshot
+    void fillSnapshot(ShipSnapshot& state) const;
+
+    // Append the current position to the trail if it has moved far enough or
+    // enough time has passed (called after every step)
+    void recordTrail(double dt);
+
+private:
+    // Trail after either kind of step
+    void afterStep(double dt);
 };
\ No newline at end of file
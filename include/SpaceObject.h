@@ -3,26 +3,24 @@
 #include <vector>
 #include <memory>
 #include "Utils.h"
-
-// forward declaration
-class CelestialBody;
+#include "ResourceManager.h"
+#include "SpriteBatch.h"
 
 // Base class for objects in space
 class SpaceObject {
 public:
-    Vector2D position;
-    Vector2D velocity;
-    double mass;
-    SDL_Texture* texture;
+    SpriteHandle sprite; // Shared with every object using the same image
     int size;
     
-    SpaceObject(double mass, Vector2D pos, Vector2D vel, int size);
+    SpaceObject(int size);
     
     virtual ~SpaceObject();
     
-    virtual void update(const std::vector<std::shared_ptr<CelestialBody>>& bodies, double dt, bool RK4=true) = 0;
+    // Current world position (owned by the simulation thread while it runs)
+    virtual Vector2D getPosition() const = 0;
     
-    virtual void render(SDL_Renderer* renderer, Vector2D cameraOffset, double scale);
+    // Queue the sprite at a world position taken from a simulation snapshot
+    virtual void render(SpriteBatch& sprites, Vector2D worldPos, Vector2D cameraOffset, double scale);
     
-    void loadTexture(SDL_Renderer* renderer, const char* path);
-};
\ No newline at end of file
+    void loadSprite(ResourceManager& resources, const char* path);
+};
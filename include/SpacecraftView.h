@@ -0,0 +1,27 @@
+#pragma once
+#include "SpaceObject.h"
+#include "SpaceCraft.h"
+#include "LineBatch.h"
+#include "TrajectoryPredictor.h"
+
+// Draws a Spacecraft from snapshots; holds its sprite, never its physics
+class SpacecraftView : public SpaceObject {
+public:
+    const Spacecraft* ship;
+
+    SpacecraftView(const Spacecraft& ship, int size);
+
+    // Only valid on the simulation thread, or when it isn't running
+    Vector2D getPosition() const override { return ship->position; }
+
+    // Queue the recorded trail, fading out towards its oldest point, plus a final
+    // segment to the ship's current position
+    void renderTrail(LineBatch& batch, const std::vector<Vector2D>& trail, Vector2D head, Vector2D cameraOffset, double scale);
+
+    // Queue the predicted coasting path from the ship onwards, fading out towards
+    // its end, with a marker at each event
+    void renderPrediction(LineBatch& batch, const Trajectory& path, double now, Vector2D head, Vector2D cameraOffset, double scale);
+    
+    // Draw the thrust plume from a snapshot, over the sprite (which goes through render)
+    void renderThrust(SDL_Renderer* renderer, const ShipSnapshot& state, Vector2D worldPos, Vector2D cameraOffset, double scale);
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Broadphase over axis-aligned boxes: a stack of uniform grids, each level's
+// cells four times wider than the one below, hashed so only occupied cells
+// cost memory. Every box lives on the finest level where it spans at most 2x2
+// cells, so stars next to pebbles and slow next to fast movers all stay O(1)
+// each. Objects are kept between calls and only move between cells when their
+// cell range changes, so slow movers cost a comparison.
+//
+// A box can also cover just part of a time step (slice j of 2^depth equal
+// parts), so a fast mover can be entered as a chain of short boxes. Time is
+// hashed like space: boxes only meet when their slices overlap.
+class SpatialHash {
+public:
+    static const int LEVELS = 16;
+    static const int DEPTHS = 8; // Time slicing up to 2^(DEPTHS-1) parts
+    static const uint32_t NONE = UINT32_MAX;
+
+    // Level 0 cell size; drops every object
+    void setCellSize(double size);
+    double getCellSize() const { return levelSize[0]; }
+
+    void clear();
+
+    // Insert or move object id (ids are small dense integers)
+    void update(uint32_t id, double minX, double minY, double maxX, double maxY, uint8_t depth = 0, uint32_t slice = 0);
+    void remove(uint32_t id);
+
+    // Calls pair(a, b) exactly once for every two objects whose boxes overlap
+    template <typename Pair>
+    void forEachPair(Pair pair) {
+        preparePairs();
+        forEachPair(0, pairWork(), pair);
+    }
+
+    // The same search in parts that can run concurrently: after preparePairs(),
+    // the ranges of [0, pairWork()) between them report every pair once
+    void preparePairs();
+    size_t pairWork() const { return buckets.size() + boxes.size(); }
+    template <typename Pair>
+    void forEachPair(size_t begin, size_t end, Pair pair) const;
+
+private:
+    struct Box {
+        double minX, minY, maxX, maxY;
+        int64_t cellX0, cellY0, cellX1, cellY1; // Inclusive cell range on its level
+        int32_t level;                          // LEVELS for boxes too big for any level
+        uint32_t slice;                         // Time slice out of 2^depth
+        uint8_t depth;
+        bool present;
+        uint32_t entry[4];                      // Its cells' entries, row by row
+    };
+
+    struct Bounds {
+        double minX, minY, maxX, maxY;
+    };
+
+    // One per (box, cell), chained per bucket
+    struct Entry {
+        uint32_t id; // NONE while on the free list
+        uint32_t slice;
+        int32_t level;
+        int32_t depth;
+        int64_t cellX, cellY;
+        uint32_t next, prev; // prev is NONE at the head of a chain
+
+        bool in(int32_t l, int32_t d, uint32_t s, int64_t cx, int64_t cy) const {
+            return cellX == cx && cellY == cy && slice == s && level == l && depth == d;
+        }
+    };
+
+    double levelSize[LEVELS] = {1};
+    std::vector<Box> boxes;                  // By id
+    std::vector<uint32_t> buckets; // First entry of each chain; cells share buckets by hash
+    std::vector<Entry> entries;    // Pool behind the chains
+    uint32_t freeEntry = NONE;
+    size_t bucketMask = 0;
+    size_t entryCount = 0;
+    size_t occupied[LEVELS][DEPTHS] = {}; // Boxes per level and depth
+
+    // From preparePairs: the occupied (level, depth) pairs and the bounds around their boxes
+    struct Layer {
+        int32_t level, depth;
+        Bounds bounds;
+    };
+    std::vector<Layer> layers;
+    std::vector<uint32_t> huge;           // Boxes above the top level, tested against everything
+
+    size_t bucketOf(int32_t level, int32_t depth, uint32_t slice, int64_t cellX, int64_t cellY) const;
+    static int64_t cellCoordinate(double value, double cellSize);
+    void insertCells(uint32_t id, Box& box);
+    void removeCells(Box& box);
+    void rehash(size_t bucketCount);
+
+    static bool overlaps(const Box& a, const Box& b) {
+        // Slices nest, so two overlap when the finer one lies inside the coarser one
+        const Box& coarse = a.depth <= b.depth ? a : b;
+        const Box& fine = a.depth <= b.depth ? b : a;
+        if ((fine.slice >> (fine.depth - coarse.depth)) != coarse.slice) return false;
+        return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+    }
+};
+
+template <typename Pair>
+void SpatialHash::forEachPair(size_t begin, size_t end, Pair pair) const {
+    // Work items: the buckets, then the boxes
+    for (size_t work = begin; work < end; work++) {
+        if (work < buckets.size()) {
+            // Same level, depth and slice: pairs sharing a cell, reported in the first cell they share
+            for (uint32_t i = buckets[work]; i != NONE; i = entries[i].next) {
+                const Entry& a = entries[i];
+                for (uint32_t j = a.next; j != NONE; j = entries[j].next) {
+                    const Entry& b = entries[j];
+                    // Different cells can share a bucket
+                    if (!a.in(b.level, b.depth, b.slice, b.cellX, b.cellY)) continue;
+                    const Box& boxA = boxes[a.id];
+                    const Box& boxB = boxes[b.id];
+                    if (!overlaps(boxA, boxB)) continue;
+                    if (a.cellX != std::max(boxA.cellX0, boxB.cellX0) || a.cellY != std::max(boxA.cellY0, boxB.cellY0)) continue;
+                    pair(a.id, b.id);
+                }
+            }
+            continue;
+        }
+
+        const uint32_t id = static_cast<uint32_t>(work - buckets.size());
+        const Box& box = boxes[id];
+        if (!box.present) continue;
+
+        if (box.level >= LEVELS) {
+            // Huge boxes against everything else, and each other once
+            for (uint32_t other = 0; other < boxes.size(); other++) {
+                const Box& otherBox = boxes[other];
+                if (!otherBox.present || other == id || (otherBox.level >= LEVELS && other < id)) continue;
+                if (overlaps(box, otherBox)) pair(id, other);
+            }
+            continue;
+        }
+
+        // Everything else: each box looks up the coarser levels, and the coarser
+        // slicings of its own level. It covers at most 2x2 cells up there, and
+        // one slice or a run of finer ones.
+        for (const Layer& layer : layers) {
+            const int32_t level = layer.level;
+            const int32_t depth = layer.depth;
+            if (level < box.level || (level == box.level && depth >= box.depth)) continue;
+            const Bounds& around = layer.bounds;
+            if (box.minX > around.maxX || around.minX > box.maxX || box.minY > around.maxY || around.minY > box.maxY) continue;
+
+            uint32_t s0, s1;
+            if (depth <= box.depth) {
+                s0 = s1 = box.slice >> (box.depth - depth);
+            } else {
+                s0 = box.slice << (depth - box.depth);
+                s1 = s0 + (1u << (depth - box.depth)) - 1;
+            }
+            int64_t x0 = cellCoordinate(box.minX, levelSize[level]), x1 = cellCoordinate(box.maxX, levelSize[level]);
+            int64_t y0 = cellCoordinate(box.minY, levelSize[level]), y1 = cellCoordinate(box.maxY, levelSize[level]);
+            for (uint32_t slice = s0; slice <= s1; slice++) {
+                for (int64_t cy = y0; cy <= y1; cy++) {
+                    for (int64_t cx = x0; cx <= x1; cx++) {
+                        for (uint32_t e = buckets[bucketOf(level, depth, slice, cx, cy)]; e != NONE; e = entries[e].next) {
+                            const Entry& entry = entries[e];
+                            if (!entry.in(level, depth, slice, cx, cy)) continue;
+                            const Box& other = boxes[entry.id];
+                            if (!overlaps(box, other)) continue;
+                            if (cx != std::max(x0, other.cellX0) || cy != std::max(y0, other.cellY0)) continue;
+                            pair(id, entry.id);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+#include "ResourceManager.h"
+
+// Collects the frame's sprites and draws them from the shared atlas in a
+// single SDL_RenderGeometry call.
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    void begin();
+
+    // Queue a square sprite centered on a screen position
+    void add(const SpriteHandle& sprite, float centerX, float centerY, float size);
+
+    // Draw everything queued since begin(). Falls back to one SDL_RenderCopyF per
+    // sprite if the renderer can't draw geometry.
+    void flush(SDL_Renderer* renderer, ResourceManager& resources);
+
+private:
+    struct Quad {
+        const Sprite* sprite; // Owners keep their handles alive for the frame
+        SDL_FRect dest;
+    };
+
+    std::vector<Quad> quads;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    bool geometrySupported;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : slots(capacity + 1), head(0), tail(0) {}
+
+    // Producer side; returns false when the queue is full
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) % slots.size();
+        if (next == head.load(std::memory_order_acquire)) return false;
+        slots[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; returns false when the queue is empty
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = slots[h];
+        head.store((h + 1) % slots.size(), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head; // Next slot to pop
+    alignas(64) std::atomic<size_t> tail; // Next slot to push
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Simulation;
+
+// Versioned binary snapshot of a whole Simulation: body arrays, render info,
+// the ship with its trail, the fleet, time, warp and gravity settings. Body and
+// fleet arrays are stored raw and 64-byte aligned, so loading is one memcpy per
+// array out of a memory-mapped file instead of re-running scenario setup.
+class StateFile {
+public:
+    // Written by encode; decode also reads versions 1 (no fleet) and 2 (collisions always on)
+    static const uint32_t VERSION = 3;
+
+    // Serialize into bytes (reuses out's storage)
+    static void encode(const Simulation& simulation, std::vector<char>& out);
+
+    // Write bytes from encode to path via a temporary file, so a crash never
+    // leaves a half-written snapshot behind
+    static bool writeBytes(const std::vector<char>& bytes, const std::string& path);
+
+    static bool save(const Simulation& simulation, const std::string& path);
+
+    // Replace the simulation's state; on any error it is left untouched
+    static bool load(Simulation& simulation, const std::string& path);
+
+    // Same as load, from bytes already in memory; sourceName is for messages
+    static bool decode(Simulation& simulation, const char* data, size_t size, const std::string& sourceName);
+};
+
+// Saves snapshots without blocking the caller for the disk write: the state is
+// encoded on the calling thread, then written by a background thread
+class StateWriter {
+public:
+    StateWriter() = default;
+    ~StateWriter();
+
+    StateWriter(const StateWriter&) = delete;
+    StateWriter& operator=(const StateWriter&) = delete;
+
+    // False if the previous save is still being written
+    bool saveAsync(const Simulation& simulation, const std::string& path);
+
+    bool busy() const;
+
+    // Block until the pending write (if any) is done
+    void wait();
+
+private:
+    std::thread worker;
+    std::vector<char> buffer;     // Owned by the worker while it runs
+    std::atomic<bool> writing{false};
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads with one work-stealing deque per thread.
+// Workers pop from the back of their own deque and steal from the front of others.
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 1 runs everything inline on the calling thread (useful for debugging)
+    void setThreadCount(unsigned threadCount);
+
+    unsigned getThreadCount() const { return threadCount; }
+
+    static unsigned hardwareThreads();
+
+    // Calls body(begin, end) over [0, count) in chunks of at most grain items and
+    // blocks until all chunks ran. The caller thread works on chunks too.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+private:
+    struct Task {
+        size_t begin, end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    unsigned threadCount;
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues; // Index 0 belongs to the calling thread
+
+    const std::function<void(size_t, size_t)>* currentBody;
+    std::atomic<size_t> remaining;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation;
+    bool stopping;
+
+    void start();
+    void stop();
+    void workerLoop(unsigned index);
+    bool runOne(unsigned index);
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BodyStore.h"
+#include "Constants.h"
+#include "Gravity.h"
+#include "Integrator.h"
+#include "SpaceCraft.h"
+#include "TripleBuffer.h"
+#include "Utils.h"
+
+class Simulation;
+
+// Something worth marking along a predicted path
+struct TrajectoryEvent {
+    enum class Type : uint8_t { ClosestApproach, SoiExit, SoiEnter };
+
+    Type type;
+    int32_t body;      // Index in the simulation's BodyStore, for the prediction's bodyLayout
+    double time;       // Simulated seconds
+    Vector2D position; // Where the ship is then
+    double distance;   // From the body; for SOI events, the sphere's radius
+};
+
+// Where the player's ship goes if it coasts from now on
+struct Trajectory {
+    double startTime = 0; // Simulated time of points[0]
+    double step = 0;      // Seconds between points
+    std::vector<Vector2D> points;
+    std::vector<TrajectoryEvent> events; // In time order
+    uint64_t bodyLayout = 0;             // Layout the event body indices refer to
+    uint64_t version = 0;                // Bumped by every publish
+
+    double endTime() const { return points.empty() ? startTime : startTime + (points.size() - 1) * step; }
+};
+
+// Integrates the ship's coasting path on a background thread, against a private
+// copy of the massive bodies (belts and rings barely bend a ship's path and would
+// dominate the cost). Each submit hands over the current state; while the ship
+// coasts on the path already predicted, the worker only drops the past and
+// extends the end, so a prediction costs a few steps per tick instead of a
+// whole horizon. Thrust, new bodies, a jump in time or drift past the
+// tolerance start it over from the submitted state.
+class TrajectoryPredictor {
+public:
+    double horizon = PREDICTION_HORIZON; // Seconds ahead of the ship
+    double step = PREDICTION_STEP;       // Seconds between predicted points
+
+    TrajectoryPredictor();
+    ~TrajectoryPredictor();
+
+    TrajectoryPredictor(const TrajectoryPredictor&) = delete;
+    TrajectoryPredictor& operator=(const TrajectoryPredictor&) = delete;
+
+    // Simulation thread: queue the current state and return. Requests the worker
+    // hasn't picked up yet are replaced, so it never falls behind.
+    void submit(const Simulation& simulation);
+
+    // Render thread: the newest published prediction (empty until the first one)
+    const Trajectory& latest();
+
+    // The whole prediction on the calling thread
+    static Trajectory predict(const Simulation& simulation, double horizon, double step);
+
+private:
+    // Everything the worker needs from the simulation, copied on submit
+    struct Request {
+        double time = 0;
+        uint64_t bodyLayout = 0;
+        BodyStore bodies;             // The massive bodies only
+        std::vector<int32_t> simIndex; // Simulation index of each
+        Vector2D position, velocity;
+        double mass = 0;
+        bool thrusting = false;
+        IntegratorType integrator = IntegratorType::DormandPrince45;
+        bool patchedConics = true;
+        double soiThreshold = 0;
+    };
+
+    // A path being integrated: the bodies and a ship copy at the last point
+    struct Path {
+        BodyStore bodies;
+        GravitySolver gravity;
+        Spacecraft ship;
+        std::vector<int32_t> simIndex;
+        uint64_t bodyLayout = 0;
+        bool fromThrust = false; // Started while the engine burned
+        double step = 0;
+
+        // points[i] and velocities[i] are at baseTime + i * step
+        double baseTime = 0;
+        std::vector<Vector2D> points, velocities;
+        std::vector<TrajectoryEvent> events;
+
+        // Event tracking per body: distance at the last two points and the
+        // sphere of influence at the last one
+        std::vector<double> distance, previousDistance, soiRadius;
+        std::vector<double> nextDistance, nextSoiRadius; // Scratch for the newest point
+        int32_t soiBody = -1; // Innermost sphere the ship is in
+
+        Path();
+
+        double endTime() const { return baseTime + (points.size() - 1) * step; }
+
+        void restart(const Request& request, double stepSize);
+        void advance(); // One step, recording the point and any events
+        void dropBefore(double time);
+
+        // Interpolated ship position at a time within the path
+        Vector2D positionAt(double time) const;
+
+    private:
+        void detectEvents();
+    };
+
+    Request pending, working;
+    bool hasPending = false;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker; // Started by the first submit
+
+    // Simulation thread: which bodies count as massive, for selectedLayout
+    std::vector<int32_t> selected;
+    uint64_t selectedLayout = 0;
+    bool selectionValid = false;
+
+    Path path; // Worker thread
+    TripleBuffer<Trajectory> results;
+    uint64_t publishCount = 0;
+
+    static void capture(const Simulation& simulation, const std::vector<int32_t>& indices, Request& request);
+    static void fill(const Path& path, double from, Trajectory& out);
+
+    void run();
+    bool process(const Request& request); // True if the path changed
+};
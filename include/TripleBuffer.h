@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one writer and one reader.
+// The writer fills writeBuffer() and publishes it; the reader swaps in the
+// newest published buffer with update(). Neither side ever blocks.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : shared(1), writeIndex(0), readIndex(2) {}
+
+    // Writer side
+    T& writeBuffer() { return buffers[writeIndex]; }
+
+    void publish() {
+        writeIndex = shared.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side: returns true if a newer buffer was swapped in
+    bool update() {
+        if (!(shared.load(std::memory_order_relaxed) & FRESH)) return false;
+        readIndex = shared.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH = 4; // Set when the shared buffer holds an unread publish
+
+    T buffers[3];
+    std::atomic<uint8_t> shared; // Index of the buffer in the middle, plus FRESH
+    uint8_t writeIndex;
+    uint8_t readIndex;
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "QuadTree.h"
+#include "Utils.h"
+
+// Per-frame visibility for bodies. Pinned bodies (the few with sprites and
+// names) are tested one by one; the rest go through a quadtree so cost follows
+// what is on screen, and groups that fit inside a pixel collapse to one point.
+class ViewCuller {
+public:
+    std::vector<uint32_t> visible;  // Body indices to draw individually
+    std::vector<Vector2D> clusters; // Centroids of sub-pixel groups
+
+    // Rebuild for this frame. Objects are kept while within marginPixels plus
+    // marginWorld of the viewport; pinned may be null.
+    void update(const double* x, const double* y, const uint8_t* pinned, size_t n,
+                Vector2D cameraOffset, double scale, double marginPixels, double marginWorld);
+
+private:
+    QuadTree tree;
+    std::vector<double> bulkX, bulkY, bulkWeight;
+    std::vector<uint32_t> bulkIndex; // Tree input index -> body index
+    std::vector<uint32_t> hits;
+    std::vector<int32_t> clusterNodes;
+};
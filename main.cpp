@@ -1,9 +1,32 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
 
 #include "include/Game.h"
 
 int main(int argc, char* args[]) {
     Game game;
+
+    // --threads N sets the physics worker count (1 = single-threaded),
+    // --scenario FILE builds the system from a scenario file,
+    // --load FILE starts from a saved state,
+    // --deterministic gives reproducible physics with tick-stamped input,
+    // --record FILE records the session, --replay FILE plays one back
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(args[i], "--threads") == 0 && i + 1 < argc) {
+            game.setPhysicsThreads(static_cast<unsigned>(std::atoi(args[++i])));
+        } else if (std::strcmp(args[i], "--load") == 0 && i + 1 < argc) {
+            game.setStartState(args[++i]);
+        } else if (std::strcmp(args[i], "--scenario") == 0 && i + 1 < argc) {
+            game.setScenario(args[++i]);
+        } else if (std::strcmp(args[i], "--record") == 0 && i + 1 < argc) {
+            game.setRecording(args[++i]);
+        } else if (std::strcmp(args[i], "--replay") == 0 && i + 1 < argc) {
+            game.setReplay(args[++i]);
+        } else if (std::strcmp(args[i], "--deterministic") == 0) {
+            game.setDeterministic(true);
+        }
+    }
     
     if (!game.init()) {
         std::cerr << "Failed to initialize game" << std::endl;
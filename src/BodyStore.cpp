@@ -0,0 +1,108 @@
+#include <algorithm>
+#include "../include/BodyStore.h"
+#include "../include/Constants.h"
+#include "../include/GravityKernel.h"
+
+size_t BodyStore::add(double bodyMass, double bodyRadius, Vector2D pos, Vector2D vel) {
+    x.push_back(pos.x);
+    y.push_back(pos.y);
+    vx.push_back(vel.x);
+    vy.push_back(vel.y);
+    mass.push_back(bodyMass);
+    radius.push_back(bodyRadius);
+    parent.push_back(-1);
+    layoutVersion++;
+    return x.size() - 1;
+}
+
+bool BodyStore::setRailsParent(size_t i, int32_t parentIndex) {
+    // Parents come first so one pass in index order can move every rails body
+    if (i >= size() || parentIndex >= static_cast<int32_t>(i)) return false;
+    parent[i] = parentIndex < 0 ? -1 : parentIndex;
+    return true;
+}
+
+void BodyStore::compact(const std::vector<int32_t>& newIndex) {
+    size_t kept = 0;
+    for (size_t i = 0; i < size(); i++) {
+        if (newIndex[i] < 0) continue;
+        size_t to = static_cast<size_t>(newIndex[i]);
+        x[to] = x[i];
+        y[to] = y[i];
+        vx[to] = vx[i];
+        vy[to] = vy[i];
+        mass[to] = mass[i];
+        radius[to] = radius[i];
+        parent[to] = parent[i];
+        kept++;
+    }
+    x.resize(kept);
+    y.resize(kept);
+    vx.resize(kept);
+    vy.resize(kept);
+    mass.resize(kept);
+    radius.resize(kept);
+    parent.resize(kept);
+    layoutVersion++;
+}
+
+void BodyStore::selectMassive(double fraction, size_t limit, std::vector<int32_t>& indices) const {
+    indices.clear();
+    if (size() == 0) return;
+    double heaviest = *std::max_element(mass.begin(), mass.end());
+    for (size_t i = 0; i < size(); i++) {
+        if (mass[i] >= heaviest * fraction) indices.push_back(static_cast<int32_t>(i));
+    }
+    if (indices.size() > limit) {
+        std::nth_element(indices.begin(), indices.begin() + limit, indices.end(), [&](int32_t a, int32_t b) {
+            return mass[a] != mass[b] ? mass[a] > mass[b] : a < b;
+        });
+        indices.resize(limit);
+        std::sort(indices.begin(), indices.end());
+    }
+}
+
+void BodyStore::copySubset(const std::vector<int32_t>& indices, BodyStore& out) const {
+    out.clear();
+    out.reserve(indices.size());
+    for (int32_t i : indices) {
+        out.add(mass[i], radius[i], position(i), velocity(i));
+    }
+    for (size_t k = 0; k < indices.size(); k++) {
+        int32_t from = parent[indices[k]];
+        if (from < 0) continue;
+        auto found = std::lower_bound(indices.begin(), indices.end(), from);
+        if (found != indices.end() && *found == from) out.setRailsParent(k, static_cast<int32_t>(found - indices.begin()));
+    }
+}
+
+void BodyStore::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    mass.reserve(count);
+    radius.reserve(count);
+    parent.reserve(count);
+}
+
+void BodyStore::clear() {
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    mass.clear();
+    radius.clear();
+    parent.clear();
+    layoutVersion++;
+}
+
+Vector2D BodyStore::accelerationAt(const Vector2D& pos, GravityKernel::Path path) const {
+    double ax = 0;
+    double ay = 0;
+
+    // Bodies containing pos contribute nothing; G is applied once after the sum
+    GravityKernel::accumulate(path, x.data(), y.data(), mass.data(), radius.data(), size(), pos.x, pos.y, ax, ay);
+
+    return Vector2D(ax * GRAVITATIONAL_CONSTANT, ay * GRAVITATIONAL_CONSTANT);
+}
@@ -1,42 +1,36 @@
 #include "../include/CelestialBody.h"
 #include "../include/Constants.h"
     
-CelestialBody::CelestialBody(double mass, double radius, Vector2D pos, Vector2D vel, int renderSize) 
-    : SpaceObject(mass, pos, vel, renderSize), radius(radius) {}
+CelestialBody::CelestialBody(BodyStore& store, double mass, double radius, Vector2D pos, Vector2D vel, int renderSize) 
+    : SpaceObject(renderSize), store(&store), index(store.add(mass, radius, pos, vel)) {}
+
+CelestialBody::CelestialBody(BodyStore& store, size_t index, int renderSize)
+    : SpaceObject(renderSize), store(&store), index(index) {}
 
 
 // Calculate gravitational acceleration for other objects
 Vector2D CelestialBody::calculateGravitationalAcceleration(const Vector2D& objectPosition) const {
-    Vector2D direction = position - objectPosition;
+    Vector2D direction = getPosition() - objectPosition;
     double distance = direction.magnitude();
     
     // Avoid division by zero and apply inverse square law
-    if (distance < radius) {
+    if (distance < getRadius()) {
         return Vector2D(0, 0); // Inside the body, no gravity for simplicity
     }
     
-    double forceMagnitude = GRAVITATIONAL_CONSTANT * mass / (distance * distance);
+    double forceMagnitude = GRAVITATIONAL_CONSTANT * getMass() / (distance * distance);
     return direction.normalized() * forceMagnitude;
 }
 
-void CelestialBody::renderOrbit(SDL_Renderer* renderer, Vector2D cameraOffset) {
+void CelestialBody::renderOrbit(SDL_Renderer* renderer, CircleCache& circles, Vector2D position, double bodyRadius,
+                                Vector2D cameraOffset, double scale) {
     // For a stationary body like a star or planet in this demo, we don't render an orbit
     // but we could render influence radius or similar
-    int centerX = static_cast<int>((position.x * SCALE_FACTOR) + (SCREEN_WIDTH / 2) + cameraOffset.x);
-    int centerY = static_cast<int>((position.y * SCALE_FACTOR) + (SCREEN_HEIGHT / 2) + cameraOffset.y);
+    float centerX = static_cast<float>((position.x * scale) + (SCREEN_WIDTH / 2) + cameraOffset.x);
+    float centerY = static_cast<float>((position.y * scale) + (SCREEN_HEIGHT / 2) + cameraOffset.y);
     
     // Draw a circle to represent the gravitational influence
-    int radius = static_cast<int>(this->radius * SCALE_FACTOR / 10);
-    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 50);
-    
-    // Simple circle drawing algorithm
-    for (int w = 0; w < radius * 2; w++) {
-        for (int h = 0; h < radius * 2; h++) {
-            int dx = radius - w;
-            int dy = radius - h;
-            if ((dx*dx + dy*dy) <= (radius * radius)) {
-                SDL_RenderDrawPoint(renderer, centerX + dx, centerY + dy);
-            }
-        }
-    }
-}
\ No newline at end of file
+    float radius = static_cast<float>(bodyRadius * scale / 10);
+    if (radius < 1) return;
+    circles.drawDisc(renderer, centerX, centerY, radius, SDL_Color{100, 100, 100, 50});
+}
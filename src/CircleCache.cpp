@@ -0,0 +1,94 @@
+#include "../include/CircleCache.h"
+#include "../include/Constants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+const int CircleCache::MIN_SHIFT;
+const int CircleCache::MAX_SHIFT;
+
+CircleCache::CircleCache() {
+    std::fill(std::begin(textures), std::end(textures), nullptr);
+}
+
+CircleCache::~CircleCache() {
+    clear();
+}
+
+void CircleCache::clear() {
+    for (SDL_Texture*& texture : textures) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+}
+
+SDL_Texture* CircleCache::textureFor(SDL_Renderer* renderer, int shift) {
+    SDL_Texture*& texture = textures[shift - MIN_SHIFT];
+    if (texture) return texture;
+
+    // White disc with an anti-aliased one-pixel edge; color and alpha come from texture mods
+    int diameter = 1 << shift;
+    double radius = diameter / 2.0;
+    std::vector<uint32_t> pixels(diameter * diameter);
+    for (int y = 0; y < diameter; y++) {
+        for (int x = 0; x < diameter; x++) {
+            double dx = x + 0.5 - radius;
+            double dy = y + 0.5 - radius;
+            double coverage = std::min(std::max(radius - std::sqrt(dx*dx + dy*dy), 0.0), 1.0);
+            uint8_t alpha = static_cast<uint8_t>(coverage * 255 + 0.5);
+            uint8_t* p = reinterpret_cast<uint8_t*>(&pixels[y * diameter + x]);
+            p[0] = p[1] = p[2] = 255; // RGBA32 is byte order, whatever the endianness
+            p[3] = alpha;
+        }
+    }
+
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, diameter, diameter);
+    if (!texture) {
+        std::cerr << "Failed to create circle texture: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_UpdateTexture(texture, nullptr, pixels.data(), diameter * 4);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
+
+void CircleCache::drawDisc(SDL_Renderer* renderer, float centerX, float centerY, float radius, SDL_Color color) {
+    // Entirely off screen
+    if (centerX + radius < 0 || centerX - radius > SCREEN_WIDTH ||
+        centerY + radius < 0 || centerY - radius > SCREEN_HEIGHT) {
+        return;
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+
+    // Smaller than a pixel
+    if (radius < 0.5f) {
+        SDL_FPoint point = {centerX, centerY};
+        SDL_RenderDrawPointsF(renderer, &point, 1);
+        return;
+    }
+
+    // Covers the whole screen: every corner is inside
+    float farX = std::max(centerX, SCREEN_WIDTH - centerX);
+    float farY = std::max(centerY, SCREEN_HEIGHT - centerY);
+    if (farX*farX + farY*farY <= radius*radius) {
+        SDL_RenderFillRect(renderer, nullptr);
+        return;
+    }
+
+    // Smallest bucket at least as wide as the disc
+    int shift = MIN_SHIFT;
+    while (shift < MAX_SHIFT && (1 << shift) < 2 * radius) shift++;
+
+    SDL_Texture* texture = textureFor(renderer, shift);
+    if (!texture) return;
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+    SDL_SetTextureAlphaMod(texture, color.a);
+    SDL_FRect dest = {centerX - radius, centerY - radius, 2 * radius, 2 * radius};
+    SDL_RenderCopyF(renderer, texture, nullptr, &dest);
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/Collisions.h"
+#include "../include/Constants.h"
+#include "../include/SpaceCraft.h"
+
+namespace {
+
+const int RESIZE_INTERVAL = 256; // Steps between re-checking the cell size
+const int MAX_SLICE_DEPTH = 6;   // Fast movers split into at most 64 boxes
+const size_t PAIR_GRAIN = 16384; // Grid work items per task
+
+// Earliest t in [0, 1] at which circles moving linearly from (a0, b0) to (a1, b1)
+// come within reach of each other, or -1
+double firstContact(double ax0, double ay0, double ax1, double ay1,
+                    double bx0, double by0, double bx1, double by1, double reach) {
+    // Relative position at the start and its change over the step
+    double dx = bx0 - ax0;
+    double dy = by0 - ay0;
+    double mx = (bx1 - bx0) - (ax1 - ax0);
+    double my = (by1 - by0) - (ay1 - ay0);
+
+    double c = dx * dx + dy * dy - reach * reach;
+    if (c <= 0) return 0;
+    double a = mx * mx + my * my;
+    double b = dx * mx + dy * my;
+    if (a == 0 || b >= 0) return -1; // Not closing in
+    double discriminant = b * b - a * c;
+    if (discriminant < 0) return -1;
+    double t = (-b - std::sqrt(discriminant)) / a;
+    return t <= 1 ? t : -1;
+}
+
+}
+
+void CollisionSystem::beginStep(const BodyStore& bodies, const Spacecraft* ship, const ShipStore& fleet) {
+    startX.assign(bodies.x.begin(), bodies.x.end());
+    startY.assign(bodies.y.begin(), bodies.y.end());
+    if (ship) {
+        startX.push_back(ship->position.x);
+        startY.push_back(ship->position.y);
+    }
+    startX.insert(startX.end(), fleet.x.begin(), fleet.x.end());
+    startY.insert(startY.end(), fleet.y.begin(), fleet.y.end());
+}
+
+void CollisionSystem::detect(const BodyStore& bodies, const Spacecraft* ship, const ShipStore& fleet, ThreadPool* pool) {
+    contacts.clear();
+    const size_t n = bodies.size() + (ship ? 1 : 0) + fleet.size();
+    if (startX.size() != n) return; // Objects came or went since beginStep
+
+    endX.assign(bodies.x.begin(), bodies.x.end());
+    endY.assign(bodies.y.begin(), bodies.y.end());
+    radius.assign(bodies.radius.begin(), bodies.radius.end());
+    if (ship) {
+        endX.push_back(ship->position.x);
+        endY.push_back(ship->position.y);
+        radius.push_back(SHIP_COLLISION_RADIUS);
+    }
+    endX.insert(endX.end(), fleet.x.begin(), fleet.x.end());
+    endY.insert(endY.end(), fleet.y.begin(), fleet.y.end());
+    radius.resize(n, SHIP_COLLISION_RADIUS);
+
+    bool layoutChanged = bodies.size() != bodyCount || bodies.layoutVersion != bodyLayout ||
+                         fleet.layoutVersion != fleetLayout || (ship != nullptr) != hasShip;
+    bodyCount = bodies.size();
+    bodyLayout = bodies.layoutVersion;
+    fleetLayout = fleet.layoutVersion;
+    hasShip = ship != nullptr;
+    resizeGrid(layoutChanged);
+
+    // Swept boxes; unchanged cell ranges cost nothing in the grid. A sweep
+    // longer than a cell is cut in time, so a dense swarm moving together
+    // doesn't give every member a box covering all the others. The first
+    // slice keeps the object's id, the rest get ids past the objects.
+    const double cellSize = grid.getCellSize();
+    uint32_t nextId = static_cast<uint32_t>(n);
+    sliceOwner.clear();
+    for (size_t i = 0; i < n; i++) {
+        double dx = endX[i] - startX[i];
+        double dy = endY[i] - startY[i];
+        double sweep = std::max(std::abs(dx), std::abs(dy));
+        uint8_t depth = 0;
+        while (depth < MAX_SLICE_DEPTH && sweep > cellSize * (1 << depth)) depth++;
+
+        uint32_t slices = 1u << depth;
+        for (uint32_t j = 0; j < slices; j++) {
+            double t0 = static_cast<double>(j) / slices;
+            double t1 = static_cast<double>(j + 1) / slices;
+            double x0 = startX[i] + dx * t0, x1 = startX[i] + dx * t1;
+            double y0 = startY[i] + dy * t0, y1 = startY[i] + dy * t1;
+            uint32_t id = static_cast<uint32_t>(i);
+            if (j > 0) {
+                id = nextId++;
+                sliceOwner.push_back(static_cast<uint32_t>(i));
+            }
+            grid.update(id, std::min(x0, x1) - radius[i], std::min(y0, y1) - radius[i],
+                        std::max(x0, x1) + radius[i], std::max(y0, y1) + radius[i], depth, j);
+        }
+    }
+    for (uint32_t id = nextId; id < gridIds; id++) grid.remove(id);
+    gridIds = nextId;
+
+    // Each task keeps its own contacts; the sort below makes the merge order irrelevant
+    grid.preparePairs();
+    const size_t work = grid.pairWork();
+    const size_t tasks = (work + PAIR_GRAIN - 1) / PAIR_GRAIN;
+    taskContacts.resize(tasks);
+    auto findPairs = [&](size_t first, size_t last) {
+        for (size_t task = first; task < last; task++) {
+            std::vector<Contact>& found = taskContacts[task];
+            found.clear();
+            grid.forEachPair(task * PAIR_GRAIN, std::min(work, (task + 1) * PAIR_GRAIN), [&](uint32_t p, uint32_t q) {
+                uint32_t a = p < n ? p : sliceOwner[p - n];
+                uint32_t b = q < n ? q : sliceOwner[q - n];
+                if (a == b) return;
+                double t = firstContact(startX[a], startY[a], endX[a], endY[a], startX[b], startY[b], endX[b], endY[b],
+                                        radius[a] + radius[b]);
+                if (t >= 0) found.push_back(Contact{std::min(a, b), std::max(a, b), t});
+            });
+        }
+    };
+    if (pool) {
+        pool->parallelFor(tasks, 1, findPairs);
+    } else {
+        findPairs(0, tasks);
+    }
+    for (const std::vector<Contact>& found : taskContacts) contacts.insert(contacts.end(), found.begin(), found.end());
+
+    // Bucket order depends on the cell size and tasks on the thread count; this order doesn't
+    std::sort(contacts.begin(), contacts.end(), [](const Contact& p, const Contact& q) {
+        if (p.time != q.time) return p.time < q.time;
+        return p.a != q.a ? p.a < q.a : p.b < q.b;
+    });
+    // Pairs that met in several time slices
+    contacts.erase(std::unique(contacts.begin(), contacts.end(), [](const Contact& p, const Contact& q) {
+        return p.a == q.a && p.b == q.b;
+    }), contacts.end());
+}
+
+void CollisionSystem::resizeGrid(bool force) {
+    if (!force && ++stepsSinceSizing < RESIZE_INTERVAL) return;
+    stepsSinceSizing = 0;
+
+    // Finest cells about four times the median swept extent: typical objects sit on
+    // the bottom level, big ones go up a level or two and fast ones get sliced
+    const size_t n = endX.size();
+    extents.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        extents[i] = std::max(std::abs(endX[i] - startX[i]), std::abs(endY[i] - startY[i])) + 2 * radius[i];
+    }
+    double size = 1;
+    if (n) {
+        std::nth_element(extents.begin(), extents.begin() + n / 2, extents.end());
+        size = std::max(4 * extents[n / 2], 1.0);
+    }
+    double current = grid.getCellSize();
+    if (force || size < current / 2 || size > current * 2) {
+        grid.setCellSize(size);
+        gridIds = 0;
+    }
+}
+
+CollisionSystem::Kind CollisionSystem::kindOf(uint32_t id) const {
+    if (id < bodyCount) return Kind::Body;
+    if (hasShip && id == bodyCount) return Kind::Ship;
+    return Kind::Fleet;
+}
+
+uint32_t CollisionSystem::indexOf(uint32_t id) const {
+    if (id < bodyCount) return id;
+    if (hasShip) return id == bodyCount ? 0 : id - static_cast<uint32_t>(bodyCount) - 1;
+    return id - static_cast<uint32_t>(bodyCount);
+}
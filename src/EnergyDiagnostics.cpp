@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/EnergyDiagnostics.h"
+#include "../include/Constants.h"
+
+void DriftTracker::record(const ConservedQuantities& sample) {
+    if (!hasBaseline) {
+        baseline = sample;
+        hasBaseline = true;
+    }
+    latest = sample;
+}
+
+double DriftTracker::energyDrift() const {
+    if (!hasBaseline || baseline.energy == 0) return 0;
+    return std::fabs((latest.energy - baseline.energy) / baseline.energy);
+}
+
+double DriftTracker::angularMomentumDrift() const {
+    if (!hasBaseline || baseline.angularMomentum == 0) return 0;
+    return std::fabs((latest.angularMomentum - baseline.angularMomentum) / baseline.angularMomentum);
+}
+
+ConservedQuantities DriftTracker::measureBodies(const BodyStore& bodies) {
+    ConservedQuantities q;
+    const size_t n = bodies.size();
+    for (size_t i = 0; i < n; i++) {
+        double m = bodies.mass[i];
+        q.energy += 0.5 * m * (bodies.vx[i]*bodies.vx[i] + bodies.vy[i]*bodies.vy[i]);
+        q.angularMomentum += m * (bodies.x[i]*bodies.vy[i] - bodies.y[i]*bodies.vx[i]);
+
+        // Same inside-radius rule as the force law
+        for (size_t j = i + 1; j < n; j++) {
+            double dx = bodies.x[j] - bodies.x[i];
+            double dy = bodies.y[j] - bodies.y[i];
+            double dist = std::sqrt(dx*dx + dy*dy);
+            if (dist == 0 || dist < std::max(bodies.radius[i], bodies.radius[j])) continue;
+            q.energy -= GRAVITATIONAL_CONSTANT * m * bodies.mass[j] / dist;
+        }
+    }
+    return q;
+}
+
+ConservedQuantities DriftTracker::measureOrbit(const BodyStore& bodies, const Vector2D& position, const Vector2D& velocity) {
+    ConservedQuantities q;
+
+    // Primary = strongest pull, i.e. largest mass / r^2
+    size_t primary = bodies.size();
+    double strongest = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        double dx = bodies.x[i] - position.x;
+        double dy = bodies.y[i] - position.y;
+        double distSq = dx*dx + dy*dy;
+        if (distSq == 0) continue;
+        double pull = bodies.mass[i] / distSq;
+        if (pull > strongest) {
+            strongest = pull;
+            primary = i;
+        }
+    }
+    if (primary == bodies.size()) return q;
+
+    Vector2D r = position - bodies.position(primary);
+    Vector2D v = velocity - bodies.velocity(primary);
+    q.energy = 0.5 * (v.x*v.x + v.y*v.y) - GRAVITATIONAL_CONSTANT * bodies.mass[primary] / r.magnitude();
+    q.angularMomentum = r.x*v.y - r.y*v.x;
+    return q;
+}
@@ -1,11 +1,22 @@
+#include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <SDL2/SDL_image.h>
 
 #include "../include/Constants.h"
 #include "../include/Game.h"
+#include "../include/Profiler.h"
+#include "../include/StateFile.h"
+#include "../include/ScenarioLoader.h"
 
+// On-screen size range for bodies drawn with the shared asteroid sprite
+const double MIN_ASTEROID_PIXELS = 3;
+const double MAX_ASTEROID_PIXELS = 32;
+const double MAX_FLEET_PIXELS = 255; // Largest size a fleet ship can ask for
 
-Game::Game() : window(nullptr), renderer(nullptr), running(false), followPlayerShip(true) {
+
+Game::Game() : window(nullptr), renderer(nullptr), running(false), followPlayerShip(true), commands(1024) {
     scaleFac = SCALE_FACTOR;
 }
 
@@ -14,6 +25,9 @@ Game::~Game() {
 }
 
 bool Game::init() {
+    // The F3 overlay and the F4 trace read the profiled scopes
+    Profiler::setEnabled(true);
+
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
         return false;
@@ -39,29 +53,155 @@ bool Game::init() {
     }
     
     // Initialize game objects
+    resources.setRenderer(renderer);
     createGameObjects();
+
+    // Give the renderer something to draw before the first tick
+    startTime = std::chrono::steady_clock::now();
+    beginSnapshot();
+    publishSnapshot();
     
     running = true;
     return true;
 }
 
 void Game::createGameObjects() {
-    // Create a star at the center
-    auto star = std::make_shared<CelestialBody>(1.989e30, 696340000, Vector2D(0, 0), Vector2D(0, 0), 60);
-    star->loadTexture(renderer, "assets/star.png");
-    celestialBodies.push_back(star);
-    
-    // Create a planet in orbit
-    auto planet = std::make_shared<CelestialBody>(5.97e29, 6371000, Vector2D(1.5e13, 0), Vector2D(0, 29800), 30);
-    planet->loadTexture(renderer, "assets/planet.png");
-    celestialBodies.push_back(planet);
+    // Replay, saved state, else the scenario file, else the built-in system
+    replaying = !replayPath.empty() && replay.load(replayPath) && replay.seek(simulation, replay.startTick);
+    bool loaded = replaying || (!startStatePath.empty() && StateFile::load(simulation, startStatePath));
+    if (!loaded) loaded = ScenarioLoader::load(simulation, scenarioPath);
+    if (!loaded) {
+        std::cerr << "Using the built-in scenario" << std::endl;
+        simulation.createDefaultScenario();
+    }
+    if (!simulation.ship) simulation.createDefaultShip();
+    requestedWarp = simulation.timeWarpFactor;
+    createRenderHandles();
+
+    if (!recordPath.empty() && !replaying) {
+        recorder.start(simulation, recordPath, REPLAY_KEYFRAME_TICKS);
+    }
+}
+
+void Game::createRenderHandles() {
+    celestialBodies.clear();
+    maxSpriteSize = 0;
+    influenceMargin = 0;
+
+    // Sprite handles for bodies that have a sprite; the rest draw as asteroids
+    const BodyStore& bodies = simulation.bodies;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const BodyInfo& info = simulation.bodyInfo[i];
+        if (info.sprite.empty()) continue;
+        auto body = std::make_shared<CelestialBody>(simulation.bodies, i, info.renderSize);
+        body->loadSprite(resources, info.sprite.c_str());
+        celestialBodies.push_back(body);
+    }
     
     // Create player spacecraft
-    playerShip = std::make_shared<Spacecraft>(1000, Vector2D(1e13, 0), Vector2D(0, 1600), 1000, 50000, 20);
-    playerShip->loadTexture(renderer, "assets/spacecraft.png");
+    playerShip = std::make_shared<SpacecraftView>(*simulation.ship, 20);
+    playerShip->loadSprite(resources, "assets/spacecraft.png");
+    asteroidSprite = resources.asteroidSprite();
+    fleetSprite = resources.sprite("assets/spacecraft.png");
+
+    // Lookup from store index to handle for the renderer
+    bodyHandles.assign(bodies.size(), nullptr);
+    pinnedBodies.assign(bodies.size(), 0);
+    handleBaseIndex.clear();
+    for (auto& body : celestialBodies) {
+        bodyHandles[body->index] = body.get();
+        pinnedBodies[body->index] = 1;
+        handleBaseIndex.push_back(body->index);
+        maxSpriteSize = std::max(maxSpriteSize, body->size);
+        influenceMargin = std::max(influenceMargin, body->getRadius() / 10);
+    }
+    handleLayout = bodies.layoutVersion;
+    handleBase = bodies.layoutVersion;
+    simulation.resetBodyRemap();
+
+    // Porkchop targets by store index, so they go with the handles
+    double heaviest = 0;
+    for (size_t i = 0; i < bodies.size(); i++) heaviest = std::max(heaviest, bodies.mass[i]);
+    porkchopTargets.clear();
+    for (auto& body : celestialBodies) {
+        if (bodies.mass[body->index] < heaviest) porkchopTargets.push_back(static_cast<int32_t>(body->index));
+    }
+    std::sort(porkchopTargets.begin(), porkchopTargets.end());
+    porkchopTarget = -1;
+    porkchopStarted = -1;
+}
+
+void Game::remapRenderHandles(const SimSnapshot& snapshot) {
+    // Handles follow their bodies to their new indices; bodies merged away lose theirs
+    const size_t n = snapshot.bodyRadius.size();
+    bodyHandles.assign(n, nullptr);
+    pinnedBodies.assign(n, 0);
+    std::vector<int32_t> oldIndex, newIndex;
+    size_t kept = 0;
+    for (size_t k = 0; k < celestialBodies.size(); k++) {
+        int32_t now = snapshot.bodyRemap[handleBaseIndex[k]];
+        oldIndex.push_back(static_cast<int32_t>(celestialBodies[k]->index));
+        newIndex.push_back(now);
+        if (now < 0) continue;
+        celestialBodies[k]->index = static_cast<size_t>(now);
+        bodyHandles[now] = celestialBodies[k].get();
+        pinnedBodies[now] = 1;
+        celestialBodies[kept] = std::move(celestialBodies[k]);
+        handleBaseIndex[kept] = handleBaseIndex[k];
+        kept++;
+    }
+    celestialBodies.resize(kept);
+    handleBaseIndex.resize(kept);
+
+    // Porkchop targets are named bodies, so they move the same way
+    auto follow = [&](int32_t index) {
+        auto found = std::find(oldIndex.begin(), oldIndex.end(), index);
+        return found == oldIndex.end() ? -1 : newIndex[found - oldIndex.begin()];
+    };
+    for (int32_t& target : porkchopTargets) target = follow(target);
+    porkchopTargets.erase(std::remove(porkchopTargets.begin(), porkchopTargets.end(), -1), porkchopTargets.end());
+    std::sort(porkchopTargets.begin(), porkchopTargets.end());
+    if (porkchopTarget >= 0) porkchopTarget = follow(porkchopTarget);
+
+    handleLayout = snapshot.bodyLayout;
+}
+
+void Game::loadState(const std::string& path) {
+    if (recorder.isRecording() || replaying) {
+        std::cerr << "Quickload is disabled while recording or replaying" << std::endl;
+        return;
+    }
+
+    // The simulation thread owns the state while it runs
+    stopSimulation();
+    simulation.stateWriter.wait();
+
+    if (StateFile::load(simulation, path)) {
+        if (!simulation.ship) simulation.createDefaultShip();
+        requestedWarp = simulation.timeWarpFactor;
+        createRenderHandles();
+        beginSnapshot();
+        publishSnapshot();
+        std::cout << "Loaded " << path << std::endl;
+    }
+
+    startSimulation();
+    sendCommand(SimCommand{SimCommand::Type::SetTrailSpacing, false, Vector2D(), TRAIL_PIXEL_SPACING / scaleFac});
+}
+
+void Game::seekReplay(uint64_t tick) {
+    stopSimulation();
+    if (replay.seek(simulation, tick)) {
+        createRenderHandles();
+        beginSnapshot();
+        publishSnapshot();
+    }
+    startSimulation();
+    sendCommand(SimCommand{SimCommand::Type::SetTrailSpacing, false, Vector2D(), TRAIL_PIXEL_SPACING / scaleFac});
 }
 
 void Game::handleEvents() {
+    PROFILE_SCOPE("handle events");
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
         if (e.type == SDL_QUIT) {
@@ -72,35 +212,97 @@ void Game::handleEvents() {
                     running = false;
                     break;
                 case SDLK_w:
-                    playerShip->setThrustDirection(Vector2D(0, -1));
-                    playerShip->applyThrust(true);
+                    sendCommand(SimCommand{SimCommand::Type::Thrust, true, Vector2D(0, -1), 0});
                     break;
                 case SDLK_s:
-                    playerShip->setThrustDirection(Vector2D(0, 1));
-                    playerShip->applyThrust(true);
+                    sendCommand(SimCommand{SimCommand::Type::Thrust, true, Vector2D(0, 1), 0});
                     break;
                 case SDLK_a:
-                    playerShip->setThrustDirection(Vector2D(-1, 0));
-                    playerShip->applyThrust(true);
+                    sendCommand(SimCommand{SimCommand::Type::Thrust, true, Vector2D(-1, 0), 0});
                     break;
                 case SDLK_d:
-                    playerShip->setThrustDirection(Vector2D(1, 0));
-                    playerShip->applyThrust(true);
+                    sendCommand(SimCommand{SimCommand::Type::Thrust, true, Vector2D(1, 0), 0});
                     break;
                 case SDLK_f:
                     followPlayerShip = !followPlayerShip;
                     break;
                 case SDLK_SPACE:
                     // Toggle between normal speed and fast forward
-                    timeWarpFactor = (timeWarpFactor > 1000) ? 1000 : 5000;
+                    requestedWarp = (requestedWarp > 1000) ? 1000 : 5000;
+                    sendCommand(SimCommand{SimCommand::Type::SetWarp, false, Vector2D(), requestedWarp});
                     break;
                 case SDLK_PERIOD:  // '>'
                     // Increase time warp (up to MAX_WARP)
-                    timeWarpFactor = std::min(timeWarpFactor * 2.0, MAX_WARP);
+                    requestedWarp = std::min(requestedWarp * 2.0, MAX_WARP);
+                    sendCommand(SimCommand{SimCommand::Type::SetWarp, false, Vector2D(), requestedWarp});
                     break;
                 case SDLK_COMMA:   // '<'
                     // Decrease time warp (down to MIN_WARP)
-                    timeWarpFactor = std::max(timeWarpFactor / 2.0, MIN_WARP);
+                    requestedWarp = std::max(requestedWarp / 2.0, MIN_WARP);
+                    sendCommand(SimCommand{SimCommand::Type::SetWarp, false, Vector2D(), requestedWarp});
+                    break;
+                case SDLK_t:
+                    // Toggle single-threaded physics (for debugging) and all cores
+                    sendCommand(SimCommand{SimCommand::Type::SetThreads, false, Vector2D(), 0});
+                    break;
+                case SDLK_i:
+                    // Cycle spacecraft integrators
+                    sendCommand(SimCommand{SimCommand::Type::CycleIntegrator, false, Vector2D(), 0});
+                    break;
+                case SDLK_e:
+                    // Toggle energy / angular momentum drift diagnostics
+                    sendCommand(SimCommand{SimCommand::Type::ToggleDiagnostics, false, Vector2D(), 0});
+                    break;
+                case SDLK_k:
+                    // Toggle patched-conic coasting
+                    sendCommand(SimCommand{SimCommand::Type::TogglePatchedConics, false, Vector2D(), 0});
+                    break;
+                case SDLK_g:
+                    // Toggle Barnes-Hut and the exact O(N^2) reference
+                    sendCommand(SimCommand{SimCommand::Type::ToggleGravityMode, false, Vector2D(), 0});
+                    break;
+                case SDLK_l:
+                    // Launch a probe into the fleet, along the thrust direction last used
+                    sendCommand(SimCommand{SimCommand::Type::LaunchShip, false, snapshots.readBuffer().ship.thrustDirection,
+                                           LAUNCH_SPEED});
+                    break;
+                case SDLK_LEFTBRACKET:
+                    sendCommand(SimCommand{SimCommand::Type::AdjustTheta, false, Vector2D(), -0.1});
+                    break;
+                case SDLK_RIGHTBRACKET:
+                    sendCommand(SimCommand{SimCommand::Type::AdjustTheta, false, Vector2D(), 0.1});
+                    break;
+                case SDLK_p:
+                    // Toggle the predicted trajectory
+                    showPrediction = !showPrediction;
+                    break;
+                case SDLK_h: {
+                    // Cycle the porkchop plot through the named bodies, then hide it
+                    int32_t current = porkchopTarget;
+                    auto next = std::upper_bound(porkchopTargets.begin(), porkchopTargets.end(), current);
+                    porkchopTarget = next == porkchopTargets.end() ? -1 : *next;
+                    break;
+                }
+                case SDLK_F3:
+                    perfOverlay.visible = !perfOverlay.visible;
+                    break;
+                case SDLK_F4:
+                    writeTrace();
+                    break;
+                case SDLK_F5:
+                    sendCommand(SimCommand{SimCommand::Type::SaveState, false, Vector2D(), 0});
+                    break;
+                case SDLK_F9:
+                    loadState(QUICKSAVE_PATH);
+                    break;
+                case SDLK_LEFT:
+                    if (replaying) {
+                        uint64_t tick = snapshots.readBuffer().tick;
+                        seekReplay(tick > REPLAY_SEEK_TICKS ? tick - REPLAY_SEEK_TICKS : 0);
+                    }
+                    break;
+                case SDLK_RIGHT:
+                    if (replaying) seekReplay(snapshots.readBuffer().tick + REPLAY_SEEK_TICKS);
                     break;
             }
         } else if (e.type == SDL_KEYUP) {
@@ -109,7 +311,7 @@ void Game::handleEvents() {
                 case SDLK_s:
                 case SDLK_a:
                 case SDLK_d:
-                    playerShip->applyThrust(false);
+                    sendCommand(SimCommand{SimCommand::Type::Thrust, false, Vector2D(), 0});
                     break;
             }
         }  else if (e.type == SDL_MOUSEWHEEL) {
@@ -151,52 +353,118 @@ void Game::zoomAt(double factor, Vector2D targetPos) {
     }
     
     scaleFac = newScale;
+
+    // Keep trail points a fixed on-screen distance apart at the new zoom
+    sendCommand(SimCommand{SimCommand::Type::SetTrailSpacing, false, Vector2D(), TRAIL_PIXEL_SPACING / scaleFac});
 }
 
-void Game::update() {
-    std::cout << timeWarpFactor << "\n";
-    // For normal-to-moderate time warps (up to ~100x)
-    if (timeWarpFactor <= 10000000) {
-        // Use the multiple fixed steps approach
-        int numSteps = std::min(static_cast<int>(timeWarpFactor), 
-                                static_cast<int>(MAX_PHYSICS_STEPS_PER_FRAME));
-        double remainder = timeWarpFactor - numSteps;
-        
-        for (int i = 0; i < numSteps; i++) {
-            updatePhysics(TIME_STEP);
+void Game::simulationLoop() {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration tickInterval =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / SIM_TICK_RATE));
+    Clock::time_point nextTick = Clock::now();
+
+    while (running) {
+        SimCommand command;
+        while (commands.pop(command)) {
+            simulation.queueCommand(command);
         }
-        
-        if (remainder > 0.001) {
-            updatePhysics(TIME_STEP * remainder);
+
+        recorder.beforeTick(simulation);
+        beginSnapshot();
+        // A replay holds its last frame once the recording runs out
+        if (!replaying || simulation.tick < replay.endTick) {
+            simulation.runTick();
+        }
+        publishSnapshot();
+        if (showPrediction) predictor.submit(simulation);
+
+        // A new porkchop target: capture the orbits now, fill the grid off this thread
+        int32_t target = porkchopTarget;
+        if (target != porkchopStarted && !porkchopView.busy()) {
+            porkchopStarted = target;
+            PorkchopPlot plot;
+            if (target >= 0 && simulation.ship &&
+                plot.setShip(simulation.bodies, simulation.ship->position, simulation.ship->velocity, target, simulation.simTime)) {
+                plot.defaultWindows(PORKCHOP_VIEW_GRID);
+                porkchopView.compute(plot, target);
+            }
         }
+
+        // Fixed tick rate; if physics falls far behind, drop the backlog instead of spiralling
+        nextTick += tickInterval;
+        Clock::time_point now = Clock::now();
+        if (now > nextTick + tickInterval * 4) {
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
     }
-    // For extreme time warps (>100x)
-    else {
-        // Calculate an adaptive time step
-        double adaptiveTimeStep = std::min(TIME_STEP * 100, MAX_TIME_STEP);
-        int steps = std::min(static_cast<int>(timeWarpFactor / 100), 
-                            static_cast<int>(MAX_PHYSICS_STEPS_PER_FRAME));
-        
-        // Apply fewer, larger steps
-        for (int i = 0; i < steps; i++) {
-            updatePhysics(adaptiveTimeStep);
+}
+
+void Game::beginSnapshot() {
+    simulation.beginSnapshot(snapshots.writeBuffer());
+}
+
+void Game::publishSnapshot() {
+    SimSnapshot& snapshot = snapshots.writeBuffer();
+    simulation.fillSnapshot(snapshot);
+    snapshot.publishTime = wallSeconds();
+    snapshots.publish();
+}
+
+void Game::sendCommand(SimCommand command) {
+    // A replay takes its physics input from the recording; view settings still apply
+    if (replaying) {
+        switch (command.type) {
+            case SimCommand::Type::SetTrailSpacing:
+            case SimCommand::Type::SetThreads:
+            case SimCommand::Type::SaveState:
+            case SimCommand::Type::ToggleDiagnostics:
+                break;
+            default:
+                return;
         }
     }
-    
-    // Camera update
-    if (followPlayerShip) {
-        cameraOffset.x = -playerShip->position.x * SCALE_FACTOR;
-        cameraOffset.y = -playerShip->position.y * SCALE_FACTOR;
+    // Lockstep: schedule a few ticks ahead so every peer can apply it on the same tick
+    if (deterministic) command.tick = snapshots.readBuffer().tick + INPUT_DELAY_TICKS;
+    if (!commands.push(command)) {
+        std::cerr << "Simulation command queue full, input dropped" << std::endl;
     }
 }
 
-// New method that performs a single physics update step
-void Game::updatePhysics(double dt) {
-    playerShip->update(celestialBodies, dt);
-    
-    for (auto& body : celestialBodies) {
-        body->update(celestialBodies, dt);
+double Game::wallSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void Game::startSimulation() {
+    running = true;
+    simulationThread = std::thread(&Game::simulationLoop, this);
+}
+
+void Game::stopSimulation() {
+    running = false;
+    if (simulationThread.joinable()) {
+        simulationThread.join();
+    }
+}
+
+void Game::writeTrace() {
+    std::ofstream out("trace.json");
+    if (!out) {
+        std::cerr << "Failed to open trace.json" << std::endl;
+        return;
     }
+    Profiler::writeChromeTrace(out);
+    std::cout << "Wrote trace.json" << std::endl;
+}
+
+void Game::setDeterministic(bool enabled) {
+    deterministic = enabled;
+    simulation.setDeterministic(enabled);
+}
+
+void Game::setPhysicsThreads(unsigned threadCount) {
+    simulation.setPhysicsThreads(threadCount);
 }
 
 // void Game::updatePhysicsRK4(double dt) {
@@ -219,7 +487,7 @@ void Game::renderUI() {
     
     int indicatorX = 50;
     int indicatorY = SCREEN_HEIGHT - 50;
-    int indicatorWidth = static_cast<int>(3 * timeWarpFactor / 1000);
+    int indicatorWidth = static_cast<int>(3 * snapshots.readBuffer().timeWarpFactor / 1000);
     int indicatorHeight = 10;
     
     SDL_Rect timeWarpIndicator = {indicatorX, indicatorY, indicatorWidth, indicatorHeight};
@@ -227,23 +495,151 @@ void Game::renderUI() {
 }
 
 void Game::render() {
+    PROFILE_SCOPE("render");
+
     // Clear screen
     SDL_SetRenderDrawColor(renderer, 0, 0, 20, 255);
     SDL_RenderClear(renderer);
+
+    // Latest published state; draw between its start and end positions so
+    // motion stays smooth when frames and ticks don't line up
+    snapshots.update();
+    if (snapshots.readBuffer().bodyLayout != handleLayout && handleBase != 0 &&
+        snapshots.readBuffer().bodyRemapBase == handleBase) {
+        // Bodies merged: the snapshot says where each one went
+        remapRenderHandles(snapshots.readBuffer());
+    } else if (snapshots.readBuffer().bodyLayout != handleLayout) {
+        // The bodies changed some other way: rebuild the handles while the simulation is paused
+        stopSimulation();
+        createRenderHandles();
+        beginSnapshot();
+        publishSnapshot();
+        startSimulation();
+        snapshots.update();
+    }
+    const SimSnapshot& snapshot = snapshots.readBuffer();
+    double alpha = std::min(std::max((wallSeconds() - snapshot.publishTime) * SIM_TICK_RATE, 0.0), 1.0);
+
+    const ShipSnapshot& ship = snapshot.ship;
+    Vector2D shipPosition = ship.previousPosition + (ship.position - ship.previousPosition) * alpha;
+
+    // Camera update
+    if (followPlayerShip) {
+        cameraOffset.x = -shipPosition.x * SCALE_FACTOR;
+        cameraOffset.y = -shipPosition.y * SCALE_FACTOR;
+    }
     
-    // Render celestial bodies
-    for (auto& body : celestialBodies) {
-        body->renderOrbit(renderer, cameraOffset);
-        body->render(renderer, cameraOffset, scaleFac);
+    // Interpolated body positions, then only what can reach the screen
+    size_t bodyCount = std::min(snapshot.bodyX.size(), snapshot.bodyRadius.size());
+    bool bodiesPaired = snapshot.bodyLayout == snapshot.previousBodyLayout && snapshot.previousBodyX.size() == bodyCount;
+    renderX.resize(bodyCount);
+    renderY.resize(bodyCount);
+    for (size_t i = 0; i < bodyCount; i++) {
+        if (bodiesPaired) {
+            renderX[i] = snapshot.previousBodyX[i] + (snapshot.bodyX[i] - snapshot.previousBodyX[i]) * alpha;
+            renderY[i] = snapshot.previousBodyY[i] + (snapshot.bodyY[i] - snapshot.previousBodyY[i]) * alpha;
+        } else {
+            renderX[i] = snapshot.bodyX[i];
+            renderY[i] = snapshot.bodyY[i];
+        }
+    }
+    bool handlesValid = snapshot.bodyLayout == handleLayout && pinnedBodies.size() == bodyCount;
+    viewCuller.update(renderX.data(), renderY.data(), handlesValid ? pinnedBodies.data() : nullptr,
+                      bodyCount, cameraOffset, scaleFac, std::max<double>(maxSpriteSize, MAX_ASTEROID_PIXELS) / 2,
+                      influenceMargin);
+
+    // Render celestial bodies. Sprites are queued and drawn from the atlas together;
+    // sub-pixel clusters become one batch of points.
+    {
+        PROFILE_SCOPE("render bodies");
+        spriteBatch.begin();
+        bodyPoints.clear();
+        for (uint32_t i : viewCuller.visible) {
+            Vector2D position(renderX[i], renderY[i]);
+            CelestialBody* body = handlesValid ? bodyHandles[i] : nullptr;
+            if (body) {
+                body->renderOrbit(renderer, circleCache, position, snapshot.bodyRadius[i], cameraOffset, scaleFac);
+                body->render(spriteBatch, position, cameraOffset, scaleFac);
+            } else {
+                double pixels = std::min(std::max(2 * snapshot.bodyRadius[i] * scaleFac, MIN_ASTEROID_PIXELS), MAX_ASTEROID_PIXELS);
+                spriteBatch.add(asteroidSprite, static_cast<float>(position.x * scaleFac + SCREEN_WIDTH / 2 + cameraOffset.x),
+                                static_cast<float>(position.y * scaleFac + SCREEN_HEIGHT / 2 + cameraOffset.y),
+                                static_cast<float>(pixels));
+            }
+        }
+        for (const Vector2D& cluster : viewCuller.clusters) {
+            bodyPoints.push_back(SDL_FPoint{static_cast<float>(cluster.x * scaleFac + SCREEN_WIDTH / 2 + cameraOffset.x),
+                                            static_cast<float>(cluster.y * scaleFac + SCREEN_HEIGHT / 2 + cameraOffset.y)});
+        }
+        if (!bodyPoints.empty()) {
+            SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+            SDL_RenderDrawPointsF(renderer, bodyPoints.data(), static_cast<int>(bodyPoints.size()));
+        }
     }
     
-    // Render player spacecraft
-    playerShip->render(renderer, cameraOffset, scaleFac);
+    // Fleet ships join the same sprite batch; zoomed out they collapse to points
+    {
+        PROFILE_SCOPE("render fleet");
+        size_t fleetCount = snapshot.fleetX.size();
+        bool paired = snapshot.fleetLayout == snapshot.previousFleetLayout && snapshot.previousFleetX.size() == fleetCount;
+        fleetRenderX.resize(fleetCount);
+        fleetRenderY.resize(fleetCount);
+        for (size_t i = 0; i < fleetCount; i++) {
+            if (paired) {
+                fleetRenderX[i] = snapshot.previousFleetX[i] + (snapshot.fleetX[i] - snapshot.previousFleetX[i]) * alpha;
+                fleetRenderY[i] = snapshot.previousFleetY[i] + (snapshot.fleetY[i] - snapshot.previousFleetY[i]) * alpha;
+            } else {
+                fleetRenderX[i] = snapshot.fleetX[i];
+                fleetRenderY[i] = snapshot.fleetY[i];
+            }
+        }
+        fleetCuller.update(fleetRenderX.data(), fleetRenderY.data(), nullptr, fleetCount, cameraOffset, scaleFac,
+                           MAX_FLEET_PIXELS / 2, 0);
+
+        if (fleetSprite) {
+            for (uint32_t i : fleetCuller.visible) {
+                spriteBatch.add(fleetSprite, static_cast<float>(fleetRenderX[i] * scaleFac + SCREEN_WIDTH / 2 + cameraOffset.x),
+                                static_cast<float>(fleetRenderY[i] * scaleFac + SCREEN_HEIGHT / 2 + cameraOffset.y),
+                                static_cast<float>(snapshot.fleetSize[i]));
+            }
+        }
+        bodyPoints.clear();
+        for (const Vector2D& cluster : fleetCuller.clusters) {
+            bodyPoints.push_back(SDL_FPoint{static_cast<float>(cluster.x * scaleFac + SCREEN_WIDTH / 2 + cameraOffset.x),
+                                            static_cast<float>(cluster.y * scaleFac + SCREEN_HEIGHT / 2 + cameraOffset.y)});
+        }
+        if (!bodyPoints.empty()) {
+            SDL_SetRenderDrawColor(renderer, 120, 220, 255, 255);
+            SDL_RenderDrawPointsF(renderer, bodyPoints.data(), static_cast<int>(bodyPoints.size()));
+        }
+    }
+
+    // Trails in one batch, under the ships
+    {
+        PROFILE_SCOPE("render trails");
+        lineBatch.begin();
+        if (showPrediction) {
+            playerShip->renderPrediction(lineBatch, predictor.latest(), snapshot.simTime, shipPosition, cameraOffset, scaleFac);
+        }
+        playerShip->renderTrail(lineBatch, ship.trail, shipPosition, cameraOffset, scaleFac);
+        lineBatch.flush(renderer);
+    }
+
+    // Render player spacecraft, then every sprite in one submission
+    {
+        PROFILE_SCOPE("render sprites");
+        playerShip->render(spriteBatch, shipPosition, cameraOffset, scaleFac);
+        spriteBatch.flush(renderer, resources);
+        playerShip->renderThrust(renderer, ship, shipPosition, cameraOffset, scaleFac);
+    }
     
     // Render UI elements
     renderUI();
+    if (porkchopTarget >= 0) porkchopView.render(renderer, porkchopTarget);
+    perfOverlay.render(renderer, snapshot, requestedWarp * TIME_STEP * SIM_TICK_RATE);
     
     // Present renderer
+    PROFILE_SCOPE("present");
     SDL_RenderPresent(renderer);
 }
 
@@ -254,12 +650,18 @@ void Game::run() {
     
     Uint32 frameStart;
     int frameTime;
+
+    // Physics runs at its own fixed rate from here on
+    startSimulation();
     
+    std::chrono::steady_clock::time_point lastFrame = std::chrono::steady_clock::now();
     while (running) {
         frameStart = SDL_GetTicks();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        perfOverlay.recordFrame(std::chrono::duration<double, std::milli>(now - lastFrame).count());
+        lastFrame = now;
         
         handleEvents();
-        update();
         render();
         
         frameTime = SDL_GetTicks() - frameStart;
@@ -268,11 +670,20 @@ void Game::run() {
             SDL_Delay(frameDelay - frameTime);
         }
     }
+
+    stopSimulation();
 }
 
 void Game::cleanup() {
+    stopSimulation();
+    recorder.finish(simulation);
+
     celestialBodies.clear();
     playerShip.reset();
+    asteroidSprite.reset();
+    circleCache.clear();
+    porkchopView.clear();
+    resources.clear();
     
     if (renderer) {
         SDL_DestroyRenderer(renderer);
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/Gravity.h"
+#include "../include/Constants.h"
+#include "../include/GravityKernel.h"
+#include "../include/Kepler.h"
+
+GravitySolver::GravitySolver(BodyStore& bodies)
+    : store(&bodies), threadPool(nullptr), mode(Mode::BarnesHut), theta(0.5),
+      kernelPath(GravityKernel::activePath()), treeValid(false), accelerationsValid(false) {}
+
+void GravitySolver::setMode(Mode newMode) {
+    mode = newMode;
+    accelerationsValid = false;
+}
+
+void GravitySolver::setTheta(double openingAngle) {
+    theta = std::min(std::max(0.0, openingAngle), MAX_THETA);
+    accelerationsValid = false;
+}
+
+void GravitySolver::setKernelPath(GravityKernel::Path path) {
+    kernelPath = GravityKernel::isSupported(path) ? path : GravityKernel::bestPath();
+    accelerationsValid = false;
+}
+
+void GravitySolver::invalidate() {
+    treeValid = false;
+    accelerationsValid = false;
+}
+
+void GravitySolver::prepare() {
+    if (mode == Mode::BarnesHut && !treeValid) {
+        tree.build(store->x.data(), store->y.data(), store->mass.data(), store->radius.data(), store->size());
+        treeValid = true;
+    }
+    if (!accelerationsValid || ax.size() != store->size()) {
+        computeBodyAccelerations(mode, ax, ay);
+        accelerationsValid = true;
+    }
+}
+
+Vector2D GravitySolver::accelerationAt(const Vector2D& pos) const {
+    if (mode == Mode::Exact) {
+        return store->accelerationAt(pos, kernelPath);
+    }
+
+    double sumX = 0, sumY = 0;
+    tree.accumulate(pos.x, pos.y, theta, kernelPath, sumX, sumY);
+    return Vector2D(sumX * GRAVITATIONAL_CONSTANT, sumY * GRAVITATIONAL_CONSTANT);
+}
+
+void GravitySolver::computeBodyAccelerations(Mode useMode, std::vector<double>& outX, std::vector<double>& outY) {
+    const BodyStore& b = *store;
+    const size_t n = b.size();
+    outX.assign(n, 0.0);
+    outY.assign(n, 0.0);
+
+    // Every output slot is written by exactly one chunk, so no reduction is needed
+    std::function<void(size_t, size_t)> chunk;
+    if (useMode == Mode::BarnesHut) {
+        chunk = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                double sumX = 0, sumY = 0;
+                tree.accumulate(b.x[i], b.y[i], theta, kernelPath, sumX, sumY);
+                outX[i] = sumX * GRAVITATIONAL_CONSTANT;
+                outY[i] = sumY * GRAVITATIONAL_CONSTANT;
+            }
+        };
+    } else {
+        // Exact reference: every pair, same inside-radius rule as the tree leaves.
+        // A body sits on itself (zero distance), so the kernel skips the self term.
+        chunk = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                double sumX = 0, sumY = 0;
+                GravityKernel::accumulate(kernelPath, b.x.data(), b.y.data(), b.mass.data(), b.radius.data(), n, b.x[i], b.y[i], sumX, sumY);
+                outX[i] = sumX * GRAVITATIONAL_CONSTANT;
+                outY[i] = sumY * GRAVITATIONAL_CONSTANT;
+            }
+        };
+    }
+
+    if (threadPool) {
+        // Several chunks per thread so stealing can balance uneven tree walks
+        size_t grain = std::max<size_t>(64, n / (threadPool->getThreadCount() * 8));
+        threadPool->parallelFor(n, grain, chunk);
+    } else {
+        chunk(0, n);
+    }
+}
+
+void GravitySolver::stepBodies(double dt) {
+    BodyStore& b = *store;
+    const size_t n = b.size();
+    if (n == 0) return;
+
+    prepare();
+
+    // Rails bodies: closed-form relative motion, anchored on the parent afterwards
+    railsBodies.clear();
+    railsPosition.clear();
+    railsVelocity.clear();
+    for (size_t i = 0; i < n; i++) {
+        int32_t p = b.parent[i];
+        if (p < 0) continue;
+        Vector2D relativePosition = b.position(i) - b.position(p);
+        Vector2D relativeVelocity = b.velocity(i) - b.velocity(p);
+        double mu = GRAVITATIONAL_CONSTANT * (b.mass[p] + b.mass[i]);
+        if (Kepler::propagate(relativePosition, relativeVelocity, mu, dt)) {
+            railsBodies.push_back(i);
+            railsPosition.push_back(relativePosition);
+            railsVelocity.push_back(relativeVelocity);
+        }
+    }
+
+    // Half kick, full drift (rails bodies are overwritten below)
+    for (size_t i = 0; i < n; i++) {
+        b.vx[i] += ax[i] * (dt/2);
+        b.vy[i] += ay[i] * (dt/2);
+        b.x[i] += b.vx[i] * dt;
+        b.y[i] += b.vy[i] * dt;
+    }
+
+    // Parents have lower indices, so they are already in place
+    for (size_t k = 0; k < railsBodies.size(); k++) {
+        size_t i = railsBodies[k];
+        b.setPosition(i, b.position(b.parent[i]) + railsPosition[k]);
+    }
+
+    // Forces at the new positions; this also leaves the tree fresh for ships
+    invalidate();
+    prepare();
+
+    // Second half kick
+    for (size_t i = 0; i < n; i++) {
+        b.vx[i] += ax[i] * (dt/2);
+        b.vy[i] += ay[i] * (dt/2);
+    }
+
+    for (size_t k = 0; k < railsBodies.size(); k++) {
+        size_t i = railsBodies[k];
+        b.setVelocity(i, b.velocity(b.parent[i]) + railsVelocity[k]);
+    }
+}
+
+void GravitySolver::measureError(double& maxRelError, double& rmsRelError) {
+    maxRelError = 0;
+    rmsRelError = 0;
+    const size_t n = store->size();
+    if (n == 0) return;
+
+    if (!treeValid) {
+        tree.build(store->x.data(), store->y.data(), store->mass.data(), store->radius.data(), n);
+        treeValid = true;
+    }
+
+    std::vector<double> approxX, approxY, exactX, exactY;
+    computeBodyAccelerations(Mode::BarnesHut, approxX, approxY);
+    computeBodyAccelerations(Mode::Exact, exactX, exactY);
+
+    double sumSq = 0;
+    for (size_t i = 0; i < n; i++) {
+        double exactMag = std::sqrt(exactX[i]*exactX[i] + exactY[i]*exactY[i]);
+        if (exactMag == 0) continue;
+        double ex = approxX[i] - exactX[i];
+        double ey = approxY[i] - exactY[i];
+        double rel = std::sqrt(ex*ex + ey*ey) / exactMag;
+        maxRelError = std::max(maxRelError, rel);
+        sumSq += rel * rel;
+    }
+    rmsRelError = std::sqrt(sumSq / n);
+}
@@ -0,0 +1,209 @@
+#include <atomic>
+#include <cmath>
+#include "../include/GravityKernel.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GRAVITY_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*KernelFn)(const double*, const double*, const double*, const double*,
+                         size_t, double, double, double&, double&);
+
+void accumulateScalar(const double* x, const double* y, const double* mass, const double* radius,
+                      size_t n, double tx, double ty, double& ax, double& ay) {
+    double sumX = 0, sumY = 0;
+    for (size_t i = 0; i < n; i++) {
+        double dx = x[i] - tx;
+        double dy = y[i] - ty;
+        double distSq = dx*dx + dy*dy;
+        if (distSq == 0 || distSq < radius[i] * radius[i]) continue;
+        double s = mass[i] / (distSq * std::sqrt(distSq));
+        sumX += dx * s;
+        sumY += dy * s;
+    }
+    ax += sumX;
+    ay += sumY;
+}
+
+#ifdef GRAVITY_KERNEL_X86
+
+// SSE2 is part of x86-64, so this path needs no runtime check there.
+// One sqrt and one divide per pair give r^-3 directly.
+__attribute__((target("sse2")))
+void accumulateSSE2(const double* x, const double* y, const double* mass, const double* radius,
+                    size_t n, double tx, double ty, double& ax, double& ay) {
+    const __m128d vtx = _mm_set1_pd(tx);
+    const __m128d vty = _mm_set1_pd(ty);
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d zero = _mm_setzero_pd();
+    __m128d sumX = _mm_setzero_pd();
+    __m128d sumY = _mm_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + i), vtx);
+        __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + i), vty);
+        __m128d distSq = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+        __m128d r = _mm_loadu_pd(radius + i);
+        __m128d outside = _mm_and_pd(_mm_cmpge_pd(distSq, _mm_mul_pd(r, r)), _mm_cmpgt_pd(distSq, zero));
+
+        __m128d invCube = _mm_div_pd(one, _mm_mul_pd(distSq, _mm_sqrt_pd(distSq)));
+        __m128d s = _mm_and_pd(_mm_mul_pd(_mm_loadu_pd(mass + i), invCube), outside);
+        sumX = _mm_add_pd(sumX, _mm_mul_pd(dx, s));
+        sumY = _mm_add_pd(sumY, _mm_mul_pd(dy, s));
+    }
+
+    double lanesX[2], lanesY[2];
+    _mm_storeu_pd(lanesX, sumX);
+    _mm_storeu_pd(lanesY, sumY);
+    ax += lanesX[0] + lanesX[1];
+    ay += lanesY[0] + lanesY[1];
+
+    accumulateScalar(x + i, y + i, mass + i, radius + i, n - i, tx, ty, ax, ay);
+}
+
+// AVX2 has no double-precision rsqrt; a float rsqrt seed needs three Newton
+// steps to reach double precision, which measured slower than sqrt + divide.
+__attribute__((target("avx2")))
+void accumulateAVX2(const double* x, const double* y, const double* mass, const double* radius,
+                    size_t n, double tx, double ty, double& ax, double& ay) {
+    const __m256d vtx = _mm256_set1_pd(tx);
+    const __m256d vty = _mm256_set1_pd(ty);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d sumX = _mm256_setzero_pd();
+    __m256d sumY = _mm256_setzero_pd();
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), vtx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), vty);
+        __m256d distSq = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        __m256d r = _mm256_loadu_pd(radius + i);
+        __m256d outside = _mm256_and_pd(_mm256_cmp_pd(distSq, _mm256_mul_pd(r, r), _CMP_GE_OQ),
+                                        _mm256_cmp_pd(distSq, zero, _CMP_GT_OQ));
+
+        __m256d invCube = _mm256_div_pd(one, _mm256_mul_pd(distSq, _mm256_sqrt_pd(distSq)));
+
+        __m256d s = _mm256_and_pd(_mm256_mul_pd(_mm256_loadu_pd(mass + i), invCube), outside);
+        sumX = _mm256_add_pd(sumX, _mm256_mul_pd(dx, s));
+        sumY = _mm256_add_pd(sumY, _mm256_mul_pd(dy, s));
+    }
+
+    double lanesX[4], lanesY[4];
+    _mm256_storeu_pd(lanesX, sumX);
+    _mm256_storeu_pd(lanesY, sumY);
+    ax += (lanesX[0] + lanesX[1]) + (lanesX[2] + lanesX[3]);
+    ay += (lanesY[0] + lanesY[1]) + (lanesY[2] + lanesY[3]);
+
+    accumulateScalar(x + i, y + i, mass + i, radius + i, n - i, tx, ty, ax, ay);
+}
+
+// AVX-512 has a 14-bit double rsqrt; two Newton steps reach full precision.
+// The tail is handled with a lane mask instead of a scalar loop.
+__attribute__((target("avx512f")))
+void accumulateAVX512(const double* x, const double* y, const double* mass, const double* radius,
+                      size_t n, double tx, double ty, double& ax, double& ay) {
+    const __m512d vtx = _mm512_set1_pd(tx);
+    const __m512d vty = _mm512_set1_pd(ty);
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d threeHalves = _mm512_set1_pd(1.5);
+    const __m512d zero = _mm512_setzero_pd();
+    __m512d sumX = _mm512_setzero_pd();
+    __m512d sumY = _mm512_setzero_pd();
+
+    for (size_t i = 0; i < n; i += 8) {
+        __mmask8 load = (n - i >= 8) ? static_cast<__mmask8>(0xFF)
+                                     : static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(load, x + i), vtx);
+        __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(load, y + i), vty);
+        __m512d distSq = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+        __m512d r = _mm512_maskz_loadu_pd(load, radius + i);
+        __mmask8 outside = load & _mm512_cmp_pd_mask(distSq, _mm512_mul_pd(r, r), _CMP_GE_OQ)
+                                & _mm512_cmp_pd_mask(distSq, zero, _CMP_GT_OQ);
+
+        __m512d inv = _mm512_rsqrt14_pd(distSq);
+        __m512d halfDistSq = _mm512_mul_pd(half, distSq);
+        for (int k = 0; k < 2; k++) {
+            inv = _mm512_mul_pd(inv, _mm512_sub_pd(threeHalves, _mm512_mul_pd(halfDistSq, _mm512_mul_pd(inv, inv))));
+        }
+        __m512d invCube = _mm512_mul_pd(inv, _mm512_mul_pd(inv, inv));
+
+        __m512d s = _mm512_maskz_mul_pd(outside, _mm512_maskz_loadu_pd(load, mass + i), invCube);
+        sumX = _mm512_add_pd(sumX, _mm512_mul_pd(dx, s));
+        sumY = _mm512_add_pd(sumY, _mm512_mul_pd(dy, s));
+    }
+
+    ax += _mm512_reduce_add_pd(sumX);
+    ay += _mm512_reduce_add_pd(sumY);
+}
+
+#endif // GRAVITY_KERNEL_X86
+
+GravityKernel::Path detectPath() {
+#ifdef GRAVITY_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return GravityKernel::Path::AVX512;
+    if (__builtin_cpu_supports("avx2")) return GravityKernel::Path::AVX2;
+    if (__builtin_cpu_supports("sse2")) return GravityKernel::Path::SSE2;
+#endif
+    return GravityKernel::Path::Scalar;
+}
+
+KernelFn kernelFor(GravityKernel::Path path) {
+    switch (path) {
+#ifdef GRAVITY_KERNEL_X86
+        case GravityKernel::Path::AVX512: return accumulateAVX512;
+        case GravityKernel::Path::AVX2: return accumulateAVX2;
+        case GravityKernel::Path::SSE2: return accumulateSSE2;
+#endif
+        default: return accumulateScalar;
+    }
+}
+
+// Detected once at static initialization; the default may be changed from any thread
+const GravityKernel::Path supportedPath = detectPath();
+std::atomic<GravityKernel::Path> selectedPath{supportedPath};
+std::atomic<KernelFn> selectedKernel{kernelFor(supportedPath)};
+
+} // namespace
+
+void GravityKernel::accumulate(const double* x, const double* y, const double* mass, const double* radius,
+                               size_t n, double tx, double ty, double& ax, double& ay) {
+    selectedKernel.load(std::memory_order_relaxed)(x, y, mass, radius, n, tx, ty, ax, ay);
+}
+
+void GravityKernel::accumulate(Path path, const double* x, const double* y, const double* mass, const double* radius,
+                               size_t n, double tx, double ty, double& ax, double& ay) {
+    kernelFor(path)(x, y, mass, radius, n, tx, ty, ax, ay);
+}
+
+GravityKernel::Path GravityKernel::activePath() {
+    return selectedPath.load(std::memory_order_relaxed);
+}
+
+void GravityKernel::setPath(Path path) {
+    Path chosen = isSupported(path) ? path : supportedPath;
+    selectedPath.store(chosen, std::memory_order_relaxed);
+    selectedKernel.store(kernelFor(chosen), std::memory_order_relaxed);
+}
+
+GravityKernel::Path GravityKernel::bestPath() {
+    return supportedPath;
+}
+
+bool GravityKernel::isSupported(Path path) {
+    return static_cast<int>(path) <= static_cast<int>(supportedPath);
+}
+
+const char* GravityKernel::pathName(Path path) {
+    switch (path) {
+        case Path::AVX512: return "avx512";
+        case Path::AVX2: return "avx2";
+        case Path::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "../include/Integrator.h"
+
+const int Integrator::MAX_SUBSTEPS;
+
+std::unique_ptr<Integrator> Integrator::create(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::Euler: return std::unique_ptr<Integrator>(new EulerIntegrator());
+        case IntegratorType::RK4: return std::unique_ptr<Integrator>(new RK4Integrator());
+        case IntegratorType::Leapfrog: return std::unique_ptr<Integrator>(new LeapfrogIntegrator());
+        case IntegratorType::Yoshida4: return std::unique_ptr<Integrator>(new Yoshida4Integrator());
+        case IntegratorType::DormandPrince45: break;
+    }
+    return std::unique_ptr<Integrator>(new DormandPrinceIntegrator());
+}
+
+const char* Integrator::name(IntegratorType type) {
+    switch (type) {
+        case IntegratorType::Euler: return "Euler";
+        case IntegratorType::RK4: return "RK4";
+        case IntegratorType::Leapfrog: return "Leapfrog";
+        case IntegratorType::Yoshida4: return "Yoshida4";
+        case IntegratorType::DormandPrince45: break;
+    }
+    return "DormandPrince45";
+}
+
+bool Integrator::fromName(const char* name, IntegratorType& type) {
+    static const IntegratorType all[] = {IntegratorType::Euler, IntegratorType::RK4, IntegratorType::DormandPrince45,
+                                         IntegratorType::Leapfrog, IntegratorType::Yoshida4};
+    for (IntegratorType candidate : all) {
+        if (std::strcmp(name, Integrator::name(candidate)) == 0) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FixedStepIntegrator::advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) {
+    int substeps = static_cast<int>(std::ceil(dt / maxStep));
+    substeps = std::max(1, std::min(substeps, MAX_SUBSTEPS));
+    double h = dt / substeps;
+
+    for (int i = 0; i < substeps; i++) {
+        step(position, velocity, h, acceleration);
+    }
+}
+
+std::unique_ptr<Integrator> EulerIntegrator::clone() const {
+    return std::unique_ptr<Integrator>(new EulerIntegrator(*this));
+}
+
+void EulerIntegrator::step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) {
+    // Update velocity and position using simple Euler integration
+    velocity = velocity + (acceleration(position) * h);
+    position = position + (velocity * h);
+}
+
+std::unique_ptr<Integrator> RK4Integrator::clone() const {
+    return std::unique_ptr<Integrator>(new RK4Integrator(*this));
+}
+
+void RK4Integrator::step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) {
+    Vector2D k1_v = acceleration(position);
+    Vector2D k1_p = velocity;
+    
+    Vector2D k2_v = acceleration(position + k1_p * (h/2));
+    Vector2D k2_p = velocity + k1_v * (h/2);
+    
+    Vector2D k3_v = acceleration(position + k2_p * (h/2));
+    Vector2D k3_p = velocity + k2_v * (h/2);
+    
+    Vector2D k4_v = acceleration(position + k3_p * h);
+    Vector2D k4_p = velocity + k3_v * h;
+    
+    position = position + (k1_p + k2_p*2 + k3_p*2 + k4_p) * (h/6);
+    velocity = velocity + (k1_v + k2_v*2 + k3_v*2 + k4_v) * (h/6);
+}
+
+std::unique_ptr<Integrator> LeapfrogIntegrator::clone() const {
+    return std::unique_ptr<Integrator>(new LeapfrogIntegrator(*this));
+}
+
+void LeapfrogIntegrator::advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) {
+    // The field may have changed since the last call (bodies move), so evaluate once up front
+    cachedAcceleration = acceleration(position);
+    FixedStepIntegrator::advance(position, velocity, dt, acceleration);
+}
+
+void LeapfrogIntegrator::step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) {
+    velocity = velocity + cachedAcceleration * (h/2);
+    position = position + velocity * h;
+    cachedAcceleration = acceleration(position);
+    velocity = velocity + cachedAcceleration * (h/2);
+}
+
+std::unique_ptr<Integrator> Yoshida4Integrator::clone() const {
+    return std::unique_ptr<Integrator>(new Yoshida4Integrator(*this));
+}
+
+void Yoshida4Integrator::step(Vector2D& position, Vector2D& velocity, double h, const AccelerationFunction& acceleration) {
+    // Triple-jump coefficients: w1 = 1 / (2 - 2^(1/3)), w0 = 1 - 2 w1
+    static const double W1 = 1.0 / (2.0 - std::cbrt(2.0));
+    static const double W0 = 1.0 - 2.0 * W1;
+    static const double C1 = W1 / 2, C2 = (W0 + W1) / 2;
+
+    position = position + velocity * (C1 * h);
+    velocity = velocity + acceleration(position) * (W1 * h);
+    position = position + velocity * (C2 * h);
+    velocity = velocity + acceleration(position) * (W0 * h);
+    position = position + velocity * (C2 * h);
+    velocity = velocity + acceleration(position) * (W1 * h);
+    position = position + velocity * (C1 * h);
+}
+
+// Dormand-Prince 5(4) tableau
+namespace {
+const double A21 = 1.0/5;
+const double A31 = 3.0/40, A32 = 9.0/40;
+const double A41 = 44.0/45, A42 = -56.0/15, A43 = 32.0/9;
+const double A51 = 19372.0/6561, A52 = -25360.0/2187, A53 = 64448.0/6561, A54 = -212.0/729;
+const double A61 = 9017.0/3168, A62 = -355.0/33, A63 = 46732.0/5247, A64 = 49.0/176, A65 = -5103.0/18656;
+// 5th order weights (also the 7th stage, so its derivative is reused next step)
+const double B1 = 35.0/384, B3 = 500.0/1113, B4 = 125.0/192, B5 = -2187.0/6784, B6 = 11.0/84;
+// 5th minus embedded 4th order weights
+const double E1 = 71.0/57600, E3 = -71.0/16695, E4 = 71.0/1920, E5 = -17253.0/339200, E6 = 22.0/525, E7 = -1.0/40;
+
+double scaledError(double err, double before, double after, double tolerance) {
+    double scale = tolerance * (1.0 + std::max(std::fabs(before), std::fabs(after)));
+    return err / scale;
+}
+}
+
+std::unique_ptr<Integrator> DormandPrinceIntegrator::clone() const {
+    return std::unique_ptr<Integrator>(new DormandPrinceIntegrator(*this));
+}
+
+void DormandPrinceIntegrator::advance(Vector2D& position, Vector2D& velocity, double dt, const AccelerationFunction& acceleration) {
+    const double minStep = dt / MAX_SUBSTEPS;
+    double elapsed = 0;
+    double h = std::min(std::max(currentStep, minStep), dt);
+
+    // Stage derivatives: position rates are velocities, velocity rates are accelerations
+    Vector2D kp[7], kv[7];
+    kp[0] = velocity;
+    kv[0] = acceleration(position);
+
+    while (elapsed < dt) {
+        bool finalStep = h >= dt - elapsed;
+        double step = finalStep ? dt - elapsed : h;
+
+        kp[1] = velocity + kv[0]*(step*A21);
+        kv[1] = acceleration(position + kp[0]*(step*A21));
+        kp[2] = velocity + (kv[0]*A31 + kv[1]*A32)*step;
+        kv[2] = acceleration(position + (kp[0]*A31 + kp[1]*A32)*step);
+        kp[3] = velocity + (kv[0]*A41 + kv[1]*A42 + kv[2]*A43)*step;
+        kv[3] = acceleration(position + (kp[0]*A41 + kp[1]*A42 + kp[2]*A43)*step);
+        kp[4] = velocity + (kv[0]*A51 + kv[1]*A52 + kv[2]*A53 + kv[3]*A54)*step;
+        kv[4] = acceleration(position + (kp[0]*A51 + kp[1]*A52 + kp[2]*A53 + kp[3]*A54)*step);
+        kp[5] = velocity + (kv[0]*A61 + kv[1]*A62 + kv[2]*A63 + kv[3]*A64 + kv[4]*A65)*step;
+        kv[5] = acceleration(position + (kp[0]*A61 + kp[1]*A62 + kp[2]*A63 + kp[3]*A64 + kp[4]*A65)*step);
+
+        Vector2D newPosition = position + (kp[0]*B1 + kp[2]*B3 + kp[3]*B4 + kp[4]*B5 + kp[5]*B6)*step;
+        Vector2D newVelocity = velocity + (kv[0]*B1 + kv[2]*B3 + kv[3]*B4 + kv[4]*B5 + kv[5]*B6)*step;
+        kp[6] = newVelocity;
+        kv[6] = acceleration(newPosition);
+
+        // Embedded error estimate, worst component scaled by the tolerance
+        Vector2D errP = (kp[0]*E1 + kp[2]*E3 + kp[3]*E4 + kp[4]*E5 + kp[5]*E6 + kp[6]*E7)*step;
+        Vector2D errV = (kv[0]*E1 + kv[2]*E3 + kv[3]*E4 + kv[4]*E5 + kv[5]*E6 + kv[6]*E7)*step;
+        double err = std::max(std::max(scaledError(std::fabs(errP.x), position.x, newPosition.x, errorTolerance),
+                                       scaledError(std::fabs(errP.y), position.y, newPosition.y, errorTolerance)),
+                              std::max(scaledError(std::fabs(errV.x), velocity.x, newVelocity.x, errorTolerance),
+                                       scaledError(std::fabs(errV.y), velocity.y, newVelocity.y, errorTolerance)));
+
+        // Standard controller: grow at most 5x, shrink at most 5x per attempt
+        double factor = err > 0 ? 0.9 * std::pow(err, -0.2) : 5.0;
+        factor = std::min(5.0, std::max(0.2, factor));
+
+        if (err <= 1.0 || step <= minStep) {
+            position = newPosition;
+            velocity = newVelocity;
+            elapsed += step;
+            kp[0] = kp[6];
+            kv[0] = kv[6];
+            // A step clipped to land on dt says nothing about the natural step size
+            if (!finalStep) {
+                h = std::max(step * factor, minStep);
+            }
+        } else {
+            h = std::max(step * factor, minStep);
+        }
+    }
+
+    currentStep = h;
+}
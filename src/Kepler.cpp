@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/Kepler.h"
+
+double Kepler::stumpffC(double z) {
+    if (z > 1e-6) return (1 - std::cos(std::sqrt(z))) / z;
+    if (z < -1e-6) return (std::cosh(std::sqrt(-z)) - 1) / (-z);
+    // Series near zero avoids cancellation
+    return 1.0/2 - z/24 + z*z/720;
+}
+
+double Kepler::stumpffS(double z) {
+    if (z > 1e-6) {
+        double s = std::sqrt(z);
+        return (s - std::sin(s)) / (s * s * s);
+    }
+    if (z < -1e-6) {
+        double s = std::sqrt(-z);
+        return (std::sinh(s) - s) / (s * s * s);
+    }
+    return 1.0/6 - z/120 + z*z/5040;
+}
+
+bool Kepler::propagate(Vector2D& position, Vector2D& velocity, double mu, double dt) {
+    const double r0 = position.magnitude();
+    if (r0 == 0 || mu <= 0) return false;
+    if (dt == 0) return true;
+
+    const double sqrtMu = std::sqrt(mu);
+    const double speedSq = velocity.x*velocity.x + velocity.y*velocity.y;
+    const double radialDot = position.x*velocity.x + position.y*velocity.y; // r . v
+    const double alpha = 2 / r0 - speedSq / mu; // 1/a; > 0 ellipse, < 0 hyperbola
+
+    // Whole ellipse periods change nothing, so keep the solve small at any warp
+    if (alpha > 1e-30) {
+        double period = 2 * M_PI / (sqrtMu * std::pow(alpha, 1.5));
+        dt = std::fmod(dt, period);
+    }
+
+    // Initial guess for the universal anomaly chi
+    double chi;
+    if (alpha > 1e-30) {
+        chi = sqrtMu * alpha * dt;
+    } else if (alpha < -1e-30) {
+        double a = 1 / alpha;
+        double sign = dt > 0 ? 1.0 : -1.0;
+        double denom = radialDot + sign * std::sqrt(-mu * a) * (1 - r0 * alpha);
+        double arg = (-2 * mu * alpha * dt) / denom;
+        chi = (arg > 0) ? sign * std::sqrt(-a) * std::log(arg) : sqrtMu * dt / r0;
+    } else {
+        chi = sqrtMu * dt / r0;
+    }
+
+    // Laguerre-Conway iteration on the universal Kepler equation; converges
+    // from far worse guesses than plain Newton
+    const double n = 5;
+    const double b = radialDot / sqrtMu;
+    const double c = 1 - alpha * r0;
+    bool converged = false;
+    for (int iteration = 0; iteration < 100; iteration++) {
+        double z = alpha * chi * chi;
+        double C = stumpffC(z);
+        double S = stumpffS(z);
+        double F = b * chi * chi * C + c * chi * chi * chi * S + r0 * chi - sqrtMu * dt;
+        double dF = b * chi * (1 - z * S) + c * chi * chi * C + r0;
+        double ddF = b * (1 - z * C) + c * chi * (1 - z * S);
+
+        double root = std::sqrt(std::fabs((n - 1) * (n - 1) * dF * dF - n * (n - 1) * F * ddF));
+        double denom = dF + (dF >= 0 ? root : -root);
+        if (denom == 0) break;
+        double delta = n * F / denom;
+        chi -= delta;
+        if (std::fabs(delta) <= 1e-13 * std::max(1.0, std::fabs(chi))) {
+            converged = true;
+            break;
+        }
+    }
+    if (!converged || !std::isfinite(chi)) return false;
+
+    // Lagrange coefficients
+    double z = alpha * chi * chi;
+    double C = stumpffC(z);
+    double S = stumpffS(z);
+    double f = 1 - chi * chi / r0 * C;
+    double g = dt - chi * chi * chi / sqrtMu * S;
+    Vector2D newPosition = position * f + velocity * g;
+    double r = newPosition.magnitude();
+    if (r == 0) return false;
+    double fDot = sqrtMu / (r * r0) * (alpha * chi * chi * chi * S - chi);
+    double gDot = 1 - chi * chi / r * C;
+
+    velocity = position * fDot + velocity * gDot;
+    position = newPosition;
+    return true;
+}
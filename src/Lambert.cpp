@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/Lambert.h"
+
+namespace {
+
+const double TOLERANCE = 1e-5;     // Last step in x; convergence is cubic, so x is then good to ~1e-15
+const int MAX_ITERATIONS = 15;
+const double BATTIN_RANGE = 0.01;  // |x - 1| below this: Battin's series
+const double LAGRANGE_RANGE = 0.2; // Below this: Lagrange's form; else Lancaster's
+
+// Gauss hypergeometric 2F1(3, 1, 5/2, z) for Battin's series
+double hypergeometric(double z) {
+    double sum = 1, term = 1;
+    for (int j = 0; j < 1000; j++) {
+        term *= (3.0 + j) * (1.0 + j) / (2.5 + j) * z / (j + 1);
+        sum += term;
+        if (std::abs(term) < 1e-13) break;
+    }
+    return sum;
+}
+
+// Non-dimensional time of flight for x, by whichever expression is well
+// conditioned there; the three agree where their ranges meet
+double timeOfFlight(double x, double lambda) {
+    double distance = std::abs(x - 1);
+    if (distance >= BATTIN_RANGE && distance < LAGRANGE_RANGE) {
+        double a = 1 / (1 - x * x);
+        if (a > 0) {
+            double alpha = 2 * std::acos(x);
+            double beta = 2 * std::asin(std::sqrt(lambda * lambda / a));
+            if (lambda < 0) beta = -beta;
+            return a * std::sqrt(a) * ((alpha - std::sin(alpha)) - (beta - std::sin(beta))) / 2;
+        }
+        double alpha = 2 * std::acosh(x);
+        double beta = 2 * std::asinh(std::sqrt(-lambda * lambda / a));
+        if (lambda < 0) beta = -beta;
+        return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alpha - std::sinh(alpha))) / 2;
+    }
+
+    double e = x * x - 1;
+    double z = std::sqrt(1 + lambda * lambda * e);
+    if (distance < BATTIN_RANGE) {
+        double eta = z - lambda * x;
+        double s1 = 0.5 * (1 - lambda - x * eta);
+        double q = 4.0 / 3 * hypergeometric(s1);
+        return (eta * eta * eta * q + 4 * lambda * eta) / 2;
+    }
+    double y = std::sqrt(std::abs(e));
+    double g = x * z - lambda * e;
+    double d = e < 0 ? std::acos(g) : std::log(y * (z - lambda * x) + g);
+    return (x - lambda * z - d / y) / e;
+}
+
+}
+
+bool Lambert::solve(const Vector2D& r1, const Vector2D& r2, double tof, double mu, bool counterclockwise,
+                    Vector2D& v1, Vector2D& v2) {
+    const double r1n = r1.magnitude();
+    const double r2n = r2.magnitude();
+    if (!(tof > 0) || !(mu > 0) || r1n == 0 || r2n == 0) return false;
+
+    const double c = (r2 - r1).magnitude();
+    if (c == 0) return false;
+    const double s = (r1n + r2n + c) / 2;
+    const Vector2D ir1 = r1 * (1 / r1n);
+    const Vector2D ir2 = r2 * (1 / r2n);
+
+    // Tangential directions follow the motion; lambda < 0 means the long way round
+    double lambda = std::sqrt(std::max(1 - c / s, 0.0));
+    double cross = ir1.x * ir2.y - ir1.y * ir2.x;
+    if (cross < 0) lambda = -lambda;
+    Vector2D it1(-ir1.y, ir1.x), it2(-ir2.y, ir2.x);
+    if (!counterclockwise) {
+        lambda = -lambda;
+        it1 = it1 * -1;
+        it2 = it2 * -1;
+    }
+
+    // Initial guess from the time-of-flight curve's asymptotes
+    const double lambda2 = lambda * lambda;
+    const double lambda3 = lambda2 * lambda;
+    const double t = std::sqrt(2 * mu / (s * s * s)) * tof;
+    const double t00 = std::acos(lambda) + lambda * std::sqrt(1 - lambda2);
+    const double t1 = 2.0 / 3 * (1 - lambda3);
+    double x;
+    if (t >= t00) {
+        x = -(t - t00) / (t - t00 + 4);
+    } else if (t <= t1) {
+        x = t1 * (t1 - t) / (0.4 * (1 - lambda2 * lambda3) * t) + 1;
+    } else {
+        x = std::pow(t / t00, M_LN2 / std::log(t1 / t00)) - 1;
+    }
+
+    // Householder's third-order iteration on T(x) = t
+    bool converged = false;
+    for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+        double tx = timeOfFlight(x, lambda);
+        double umx2 = 1 - x * x;
+        double y = std::sqrt(1 - lambda2 * umx2);
+        double y3 = y * y * y;
+        double dt = (3 * tx * x - 2 + 2 * lambda3 * x / y) / umx2;
+        double ddt = (3 * tx + 5 * x * dt + 2 * (1 - lambda2) * lambda3 / y3) / umx2;
+        double dddt = (7 * x * ddt + 8 * dt - 6 * (1 - lambda2) * lambda2 * lambda3 * x / (y3 * y * y)) / umx2;
+
+        double delta = tx - t;
+        double dt2 = dt * dt;
+        double next = x - delta * (dt2 - delta * ddt / 2) / (dt * (dt2 - delta * ddt) + dddt * delta * delta / 6);
+        if (!std::isfinite(next)) return false;
+        double change = std::abs(next - x);
+        x = next;
+        if (change < TOLERANCE) {
+            converged = true;
+            break;
+        }
+    }
+    if (!converged) return false;
+
+    // Velocities from x: radial and tangential components at each end
+    const double gamma = std::sqrt(mu * s / 2);
+    const double rho = (r1n - r2n) / c;
+    const double sigma = std::sqrt(std::max(1 - rho * rho, 0.0));
+    const double y = std::sqrt(1 - lambda2 + lambda2 * x * x);
+    const double radial1 = gamma * ((lambda * y - x) - rho * (lambda * y + x)) / r1n;
+    const double radial2 = -gamma * ((lambda * y - x) + rho * (lambda * y + x)) / r2n;
+    const double tangential = gamma * sigma * (y + lambda * x);
+    v1 = ir1 * radial1 + it1 * (tangential / r1n);
+    v2 = ir2 * radial2 + it2 * (tangential / r2n);
+    return true;
+}
@@ -0,0 +1,130 @@
+#include "../include/LineBatch.h"
+#include "../include/Constants.h"
+#include <iostream>
+
+LineBatch::LineBatch() : geometrySupported(true) {}
+
+void LineBatch::begin() {
+    screen.clear();
+    alpha.clear();
+    ranges.clear();
+    vertices.clear();
+    indices.clear();
+}
+
+void LineBatch::appendPoint(float x, float y, size_t& kept) {
+    screen.push_back(SDL_FPoint{x, y});
+    kept++;
+}
+
+void LineBatch::addPolyline(const Vector2D* points, size_t count, Vector2D cameraOffset, double scale,
+                            SDL_Color color, Uint8 fadeAlpha, float thickness) {
+    if (count < 2) return;
+
+    Range range = {screen.size(), 0, color};
+    double offsetX = SCREEN_WIDTH / 2 + cameraOffset.x;
+    double offsetY = SCREEN_HEIGHT / 2 + cameraOffset.y;
+    float alphaStep = (static_cast<float>(color.a) - fadeAlpha) / (count - 1);
+
+    for (size_t i = 0; i < count; i++) {
+        float x = static_cast<float>(points[i].x * scale + offsetX);
+        float y = static_cast<float>(points[i].y * scale + offsetY);
+        Uint8 a = static_cast<Uint8>(fadeAlpha + alphaStep * i + 0.5f);
+
+        if (range.count > 0) {
+            const SDL_FPoint& last = screen.back();
+            float dx = x - last.x;
+            float dy = y - last.y;
+            if (dx*dx + dy*dy < 1.0f) {
+                // Sub-pixel step: drop it, but let the final point win so the line ends exactly
+                if (i == count - 1 && range.count > 1) {
+                    screen.back() = SDL_FPoint{x, y};
+                    alpha.back() = a;
+                }
+                continue;
+            }
+        }
+        appendPoint(x, y, range.count);
+        alpha.push_back(a);
+    }
+
+    if (range.count < 2) {
+        screen.resize(range.first);
+        alpha.resize(range.first);
+        return;
+    }
+    ranges.push_back(range);
+    buildGeometry(range, thickness);
+}
+
+void LineBatch::addScreenPolyline(const SDL_FPoint* points, size_t count, SDL_Color color, Uint8 fadeAlpha, float thickness) {
+    if (count < 2) return;
+
+    Range range = {screen.size(), 0, color};
+    float alphaStep = (static_cast<float>(color.a) - fadeAlpha) / (count - 1);
+    for (size_t i = 0; i < count; i++) {
+        appendPoint(points[i].x, points[i].y, range.count);
+        alpha.push_back(static_cast<Uint8>(fadeAlpha + alphaStep * i + 0.5f));
+    }
+    ranges.push_back(range);
+    buildGeometry(range, thickness);
+}
+
+void LineBatch::buildGeometry(const Range& range, float thickness) {
+    float half = thickness / 2;
+    float minX = -half, minY = -half;
+    float maxX = SCREEN_WIDTH + half, maxY = SCREEN_HEIGHT + half;
+
+    for (size_t i = range.first + 1; i < range.first + range.count; i++) {
+        const SDL_FPoint& p0 = screen[i - 1];
+        const SDL_FPoint& p1 = screen[i];
+
+        // Both ends past the same screen edge
+        if ((p0.x < minX && p1.x < minX) || (p0.x > maxX && p1.x > maxX) ||
+            (p0.y < minY && p1.y < minY) || (p0.y > maxY && p1.y > maxY)) {
+            continue;
+        }
+
+        float dx = p1.x - p0.x;
+        float dy = p1.y - p0.y;
+        float length = std::sqrt(dx*dx + dy*dy);
+        if (length == 0) continue;
+        float nx = -dy / length * half;
+        float ny = dx / length * half;
+
+        SDL_Color c0 = range.color;
+        SDL_Color c1 = range.color;
+        c0.a = alpha[i - 1];
+        c1.a = alpha[i];
+
+        int base = static_cast<int>(vertices.size());
+        vertices.push_back(SDL_Vertex{SDL_FPoint{p0.x + nx, p0.y + ny}, c0, SDL_FPoint{0, 0}});
+        vertices.push_back(SDL_Vertex{SDL_FPoint{p0.x - nx, p0.y - ny}, c0, SDL_FPoint{0, 0}});
+        vertices.push_back(SDL_Vertex{SDL_FPoint{p1.x + nx, p1.y + ny}, c1, SDL_FPoint{0, 0}});
+        vertices.push_back(SDL_Vertex{SDL_FPoint{p1.x - nx, p1.y - ny}, c1, SDL_FPoint{0, 0}});
+
+        int quad[] = {base, base + 1, base + 2, base + 1, base + 3, base + 2};
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
+
+void LineBatch::flush(SDL_Renderer* renderer) {
+    if (ranges.empty()) return;
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+    if (geometrySupported) {
+        if (indices.empty()) return; // Everything was off screen
+        if (SDL_RenderGeometry(renderer, nullptr, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size())) == 0) {
+            return;
+        }
+        std::cerr << "SDL_RenderGeometry failed, drawing lines instead: " << SDL_GetError() << std::endl;
+        geometrySupported = false;
+    }
+
+    // No per-vertex alpha on this path, so each polyline uses its end color
+    for (const Range& range : ranges) {
+        SDL_SetRenderDrawColor(renderer, range.color.r, range.color.g, range.color.b, range.color.a);
+        SDL_RenderDrawLinesF(renderer, &screen[range.first], static_cast<int>(range.count));
+    }
+}
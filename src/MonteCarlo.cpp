@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <random>
+#include "../include/MonteCarlo.h"
+#include "../include/Constants.h"
+#include "../include/Gravity.h"
+#include "../include/Integrator.h"
+#include "../include/SpaceCraft.h"
+#include "../include/Simulation.h"
+
+namespace {
+
+const size_t BATCH_SIZE = 64; // Ships flown together against one copy of the bodies
+
+// A dispersed ship between steps; swapped into a scratch Spacecraft to step it
+struct Flight {
+    Vector2D position, velocity;
+    double fuel = 0;
+    double enginePower = 0;
+    Vector2D direction;
+    std::unique_ptr<Integrator> integrator;
+
+    // Coasting this step: the primary and the state relative to it
+    int primary = -1;
+    Vector2D relativePosition, relativeVelocity;
+
+    // Distance to the target at the last two step boundaries, closest so far
+    double previousDistance = 0, distance = 0, closest = 0;
+};
+
+void swapInto(Spacecraft& craft, Flight& flight) {
+    std::swap(craft.position, flight.position);
+    std::swap(craft.velocity, flight.velocity);
+    std::swap(craft.fuel, flight.fuel);
+    std::swap(craft.enginePower, flight.enginePower);
+    std::swap(craft.thrustDirection, flight.direction);
+    craft.integrator.swap(flight.integrator);
+}
+
+// Smallest value of the parabola through three distances at t0 < t1 < t2,
+// where d1 is the smallest of them
+double refinedMinimum(double t0, double d0, double t1, double d1, double t2, double d2) {
+    double h0 = t1 - t0, h1 = t2 - t1;
+    double s0 = (d1 - d0) / h0, s1 = (d2 - d1) / h1;
+    double curvature = (s1 - s0) / (h0 + h1);
+    if (!(curvature > 0)) return d1;
+    double slope = (s0 * h1 + s1 * h0) / (h0 + h1);
+    return std::max(d1 - slope * slope / (4 * curvature), 0.0);
+}
+
+// Linear interpolation between the closest ranks
+double percentile(const std::vector<double>& sorted, double p) {
+    double rank = p * (sorted.size() - 1);
+    size_t below = static_cast<size_t>(rank);
+    if (below + 1 >= sorted.size()) return sorted.back();
+    return sorted[below] + (sorted[below + 1] - sorted[below]) * (rank - below);
+}
+
+DispersionStats summarize(std::vector<double> values) {
+    DispersionStats stats;
+    if (values.empty()) return stats;
+    // Sorted first, so the sums come out the same however the batches ran
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double v : values) sum += v;
+    stats.mean = sum / values.size();
+    double squares = 0;
+    for (double v : values) squares += (v - stats.mean) * (v - stats.mean);
+    stats.stddev = std::sqrt(squares / values.size());
+    stats.min = values.front();
+    stats.p50 = percentile(values, 0.5);
+    stats.p90 = percentile(values, 0.9);
+    stats.p99 = percentile(values, 0.99);
+    stats.max = values.back();
+    return stats;
+}
+
+void writeStats(std::ostream& out, const char* name, const DispersionStats& stats) {
+    out << "  \"" << name << "\": {\"mean\": " << stats.mean << ", \"stddev\": " << stats.stddev
+        << ", \"min\": " << stats.min << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90
+        << ", \"p99\": " << stats.p99 << ", \"max\": " << stats.max << "}";
+}
+
+}
+
+void DispersionRunner::record(const BodyStore& state) {
+    ephemerisX.insert(ephemerisX.end(), state.x.begin(), state.x.end());
+    ephemerisY.insert(ephemerisY.end(), state.y.begin(), state.y.end());
+    ephemerisVx.insert(ephemerisVx.end(), state.vx.begin(), state.vx.end());
+    ephemerisVy.insert(ephemerisVy.end(), state.vy.begin(), state.vy.end());
+}
+
+void DispersionRunner::load(size_t boundary, BodyStore& state) const {
+    const size_t n = state.size();
+    const size_t offset = boundary * n;
+    std::copy(ephemerisX.begin() + offset, ephemerisX.begin() + offset + n, state.x.begin());
+    std::copy(ephemerisY.begin() + offset, ephemerisY.begin() + offset + n, state.y.begin());
+    std::copy(ephemerisVx.begin() + offset, ephemerisVx.begin() + offset + n, state.vx.begin());
+    std::copy(ephemerisVy.begin() + offset, ephemerisVy.begin() + offset + n, state.vy.begin());
+}
+
+Vector2D DispersionRunner::fly(const Spacecraft& ship, size_t first, size_t count, bool perturb) {
+    BodyStore state = bodies;
+    GravitySolver gravity(state);
+    gravity.setMode(GravitySolver::Mode::Exact);
+
+    Spacecraft craft(ship.mass, ship.position, ship.velocity, ship.fuel, ship.enginePower);
+    craft.setTrailCapacity(1);
+    craft.patchedConics = ship.patchedConics;
+    craft.soiThreshold = ship.soiThreshold;
+
+    std::vector<Flight> flights(count);
+    for (size_t f = 0; f < count; f++) {
+        Flight& flight = flights[f];
+        flight.position = ship.position;
+        flight.velocity = ship.velocity;
+        flight.fuel = ship.fuel;
+        flight.enginePower = ship.enginePower;
+        flight.direction = maneuver.direction.normalized();
+        flight.integrator = ship.integrator->clone();
+        if (perturb) {
+            // Drawn from the seed and the instance alone, so a ship's errors don't
+            // depend on which batch or thread flies it
+            const uint64_t instance = first + f;
+            std::seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                                   static_cast<uint32_t>(instance), static_cast<uint32_t>(instance >> 32)};
+            std::mt19937_64 random(sequence);
+            std::normal_distribution<double> normal;
+            // One statement per draw: the order of arguments' evaluation is unspecified
+            double positionX = normal(random);
+            double positionY = normal(random);
+            double velocityX = normal(random);
+            double velocityY = normal(random);
+            double thrust = normal(random);
+            double pointing = normal(random);
+            flight.position = flight.position + Vector2D(positionX, positionY) * dispersion.position;
+            flight.velocity = flight.velocity + Vector2D(velocityX, velocityY) * dispersion.velocity;
+            flight.enginePower *= std::max(1 + thrust * dispersion.thrust, 0.0);
+            double angle = pointing * dispersion.pointing;
+            double c = std::cos(angle), s = std::sin(angle);
+            flight.direction = Vector2D(flight.direction.x * c - flight.direction.y * s,
+                                        flight.direction.x * s + flight.direction.y * c);
+        }
+        if (targetIndex >= 0) {
+            flight.distance = (state.position(targetIndex) - flight.position).magnitude();
+            flight.closest = flight.distance;
+        }
+    }
+
+    // Time-major, so the bodies are loaded once per step for the whole batch;
+    // each step follows Simulation::updatePhysics
+    double previousTime = 0, time = 0;
+    for (size_t k = 0; k < steps.size(); k++) {
+        const double dt = steps[k];
+        gravity.prepare();
+        for (Flight& flight : flights) {
+            swapInto(craft, flight);
+            craft.thrustActive = burning[k] && craft.fuel > 0;
+            flight.primary = craft.coastingPrimary(gravity);
+            if (flight.primary >= 0) {
+                flight.relativePosition = craft.position - state.position(flight.primary);
+                flight.relativeVelocity = craft.velocity - state.velocity(flight.primary);
+            } else {
+                craft.update(gravity, dt);
+            }
+            swapInto(craft, flight);
+        }
+
+        load(k + 1, state);
+        gravity.invalidate();
+        const double nextTime = time + dt;
+        for (Flight& flight : flights) {
+            if (flight.primary >= 0) {
+                swapInto(craft, flight);
+                craft.coast(gravity, flight.primary, flight.relativePosition, flight.relativeVelocity, dt);
+                swapInto(craft, flight);
+            }
+            if (targetIndex < 0) continue;
+
+            // Closest approach: every boundary, and between them a parabola
+            // through the last three distances around a local minimum
+            double next = (state.position(targetIndex) - flight.position).magnitude();
+            if (k > 0 && flight.distance < flight.previousDistance && flight.distance <= next) {
+                flight.closest = std::min(flight.closest, refinedMinimum(previousTime, flight.previousDistance, time,
+                                                                         flight.distance, nextTime, next));
+            }
+            flight.closest = std::min(flight.closest, next);
+            flight.previousDistance = flight.distance;
+            flight.distance = next;
+        }
+        previousTime = time;
+        time = nextTime;
+    }
+
+    for (size_t f = 0; f < count; f++) {
+        const Flight& flight = flights[f];
+        miss[first + f] = targetIndex >= 0 ? flight.closest : (flight.position - nominalEnd).magnitude();
+        fuel[first + f] = ship.fuel - flight.fuel;
+    }
+    return flights.empty() ? ship.position : flights.back().position;
+}
+
+bool DispersionRunner::run(const Simulation& simulation, ThreadPool* pool) {
+    if (!simulation.ship || !(duration > 0) || !(maxStep > 0)) return false;
+    const BodyStore& all = simulation.bodies;
+    if (target >= static_cast<int32_t>(all.size())) return false;
+    const Spacecraft& ship = *simulation.ship;
+
+    // The bodies that bend a ship's path, and the target however light it is
+    std::vector<int32_t> indices;
+    all.selectMassive(PREDICTION_MASS_FRACTION, PREDICTION_MAX_BODIES, indices);
+    targetIndex = -1;
+    if (target >= 0) {
+        auto at = std::lower_bound(indices.begin(), indices.end(), target);
+        if (at == indices.end() || *at != target) at = indices.insert(at, target);
+        targetIndex = static_cast<int32_t>(at - indices.begin());
+    }
+    all.copySubset(indices, bodies);
+
+    // Equal steps of at most maxStep before, during and after the burn. The burn
+    // is also split where the unperturbed ship runs dry; weaker engines burn on
+    // past it, stronger ones stop within a step.
+    const double burnStart = std::min(std::max(maneuver.start, 0.0), duration);
+    const double burnEnd = std::min(std::max(maneuver.end, burnStart), duration);
+    const double burnout = ship.enginePower > 0
+                               ? std::min(burnStart + ship.fuel / (ship.enginePower * FUEL_PER_THRUST), burnEnd)
+                               : burnEnd;
+    const double bounds[] = {0, burnStart, burnout, burnEnd, duration};
+    steps.clear();
+    burning.clear();
+    for (int part = 0; part < 4; part++) {
+        double span = bounds[part + 1] - bounds[part];
+        if (!(span > 0)) continue;
+        size_t count = static_cast<size_t>(std::ceil(span / maxStep));
+        steps.insert(steps.end(), count, span / count);
+        burning.insert(burning.end(), count, part == 1 || part == 2);
+    }
+
+    // The bodies don't feel the ships, so one pass serves every ship
+    ephemerisX.clear();
+    ephemerisY.clear();
+    ephemerisVx.clear();
+    ephemerisVy.clear();
+    {
+        BodyStore state = bodies;
+        GravitySolver gravity(state);
+        gravity.setMode(GravitySolver::Mode::Exact);
+        record(state);
+        for (double dt : steps) {
+            gravity.prepare();
+            gravity.stepBodies(dt);
+            record(state);
+        }
+    }
+
+    // The unperturbed ship first: without a target, misses are measured from its end
+    miss.assign(1, 0);
+    fuel.assign(1, 0);
+    nominalEnd = ship.position;
+    nominalEnd = fly(ship, 0, 1, false);
+    nominalMiss = targetIndex >= 0 ? miss[0] : 0;
+    nominalFuel = fuel[0];
+
+    miss.assign(instances, 0);
+    fuel.assign(instances, 0);
+    const size_t batches = (instances + BATCH_SIZE - 1) / BATCH_SIZE;
+    std::mutex progressMutex;
+    size_t done = 0;
+    double runningMean = 0, runningSquares = 0;
+    auto flyBatches = [&](size_t begin, size_t end) {
+        for (size_t batch = begin; batch < end; batch++) {
+            const size_t first = batch * BATCH_SIZE;
+            const size_t count = std::min(BATCH_SIZE, instances - first);
+            fly(ship, first, count, true);
+
+            // Welford's running mean and variance over the finished ships
+            std::lock_guard<std::mutex> lock(progressMutex);
+            for (size_t i = first; i < first + count; i++) {
+                done++;
+                double delta = miss[i] - runningMean;
+                runningMean += delta / done;
+                runningSquares += delta * (miss[i] - runningMean);
+            }
+            if (progress) progress(done, runningMean, std::sqrt(runningSquares / done));
+        }
+    };
+    if (pool) {
+        pool->parallelFor(batches, 1, flyBatches);
+    } else {
+        flyBatches(0, batches);
+    }
+
+    missDistance = summarize(miss);
+    fuelUsed = summarize(fuel);
+    return true;
+}
+
+void DispersionRunner::writeJson(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::setprecision(17);
+
+    out << "{\n  \"instances\": " << instances << ",\n  \"seed\": " << seed << ",\n  \"seconds\": " << duration
+        << ",\n  \"target\": " << target << ",\n  \"nominal\": {\"miss\": " << nominalMiss << ", \"fuel\": " << nominalFuel
+        << ", \"x\": " << nominalEnd.x << ", \"y\": " << nominalEnd.y << "},\n";
+    writeStats(out, "missDistance", missDistance);
+    out << ",\n";
+    writeStats(out, "fuelUsed", fuelUsed);
+    out << "\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
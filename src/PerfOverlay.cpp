@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include "../include/PerfOverlay.h"
+#include "../include/Constants.h"
+
+namespace {
+
+const int GRAPH_FRAMES = 240;
+const int PANEL_X = 10, PANEL_Y = 10, PANEL_W = GRAPH_FRAMES + 20, PANEL_H = 200;
+const int GRAPH_H = 50;          // Pixels for GRAPH_MS_RANGE
+const double GRAPH_MS_RANGE = 50;
+
+// 3x5 glyphs, rows top to bottom; '1' marks a lit pixel
+const char* glyph(char c) {
+    switch (std::toupper(static_cast<unsigned char>(c))) {
+        case '0': return "111101101101111";
+        case '1': return "010110010010111";
+        case '2': return "111001111100111";
+        case '3': return "111001111001111";
+        case '4': return "101101111001001";
+        case '5': return "111100111001111";
+        case '6': return "111100111101111";
+        case '7': return "111001001001001";
+        case '8': return "111101111101111";
+        case '9': return "111101111001111";
+        case 'A': return "010101111101101";
+        case 'B': return "110101110101110";
+        case 'C': return "011100100100011";
+        case 'D': return "110101101101110";
+        case 'E': return "111100110100111";
+        case 'F': return "111100110100100";
+        case 'G': return "011100101101011";
+        case 'H': return "101101111101101";
+        case 'I': return "111010010010111";
+        case 'J': return "001001001101010";
+        case 'K': return "101101110101101";
+        case 'L': return "100100100100111";
+        case 'M': return "101111111101101";
+        case 'N': return "110101101101101";
+        case 'O': return "010101101101010";
+        case 'P': return "110101110100100";
+        case 'Q': return "010101101110011";
+        case 'R': return "110101110101101";
+        case 'S': return "011100010001110";
+        case 'T': return "111010010010010";
+        case 'U': return "101101101101111";
+        case 'V': return "101101101101010";
+        case 'W': return "101101111111101";
+        case 'X': return "101101010101101";
+        case 'Y': return "101101010010010";
+        case 'Z': return "111001010100111";
+        case '.': return "000000000000010";
+        case ':': return "000010000010000";
+        case '/': return "001001010100100";
+        case '-': return "000000111000000";
+        default: return "000000000000000";
+    }
+}
+
+// 1234 -> "1.2K", keeps labels short
+std::string compact(double value) {
+    const char* suffixes[] = {"", "K", "M", "G", "T", "P"};
+    int unit = 0;
+    while (std::abs(value) >= 1000 && unit < 5) {
+        value /= 1000;
+        unit++;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), unit ? "%.1f%s" : "%.0f%s", value, suffixes[unit]);
+    return text;
+}
+
+}
+
+PerfOverlay::PerfOverlay()
+    : visible(false), frameTimes(GRAPH_FRAMES), framesSinceSummary(0),
+      sampleSimTime(0), samplePublishTime(0), achievedRatio(0) {}
+
+void PerfOverlay::recordFrame(double frameMs) {
+    frameTimes.push(static_cast<float>(frameMs));
+}
+
+void PerfOverlay::summarizeScopes() {
+    // Sum every scope over the last second of events
+    Profiler::collect(events);
+    if (events.empty()) return;
+    uint64_t latest = 0;
+    for (const ProfileEvent& event : events) latest = std::max(latest, event.startNs + event.durationNs);
+    uint64_t windowStart = latest > 1000000000ull ? latest - 1000000000ull : 0;
+
+    std::map<const char*, uint64_t> totals;
+    for (const ProfileEvent& event : events) {
+        if (event.startNs >= windowStart) totals[event.name] += event.durationNs;
+    }
+
+    scopes.clear();
+    for (const auto& total : totals) {
+        scopes.push_back(ScopeCost{total.first, total.second / 1e6});
+    }
+    std::sort(scopes.begin(), scopes.end(), [](const ScopeCost& a, const ScopeCost& b) {
+        return a.msPerSecond > b.msPerSecond;
+    });
+    if (scopes.size() > 6) scopes.resize(6);
+}
+
+void PerfOverlay::drawText(int x, int y, const std::string& text, int pixel) {
+    for (char c : text) {
+        const char* bits = glyph(c);
+        for (int i = 0; i < 15; i++) {
+            if (bits[i] == '1') {
+                rects.push_back(SDL_Rect{x + (i % 3) * pixel, y + (i / 3) * pixel, pixel, pixel});
+            }
+        }
+        x += 4 * pixel;
+    }
+}
+
+void PerfOverlay::render(SDL_Renderer* renderer, const SimSnapshot& snapshot, double requestedRatio) {
+    if (!visible) return;
+    PROFILE_SCOPE("overlay");
+
+    // Achieved warp from how fast simulated time advanced between snapshots
+    if (snapshot.publishTime - samplePublishTime >= 0.5) {
+        if (samplePublishTime > 0) {
+            achievedRatio = (snapshot.simTime - sampleSimTime) / (snapshot.publishTime - samplePublishTime);
+        }
+        sampleSimTime = snapshot.simTime;
+        samplePublishTime = snapshot.publishTime;
+    }
+    if (++framesSinceSummary >= 30) {
+        framesSinceSummary = 0;
+        summarizeScopes();
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 170);
+    SDL_Rect panel = {PANEL_X, PANEL_Y, PANEL_W, PANEL_H};
+    SDL_RenderFillRect(renderer, &panel);
+
+    // Frame-time graph, newest on the right
+    rects.clear();
+    int graphBottom = PANEL_Y + 10 + GRAPH_H;
+    int graphLeft = PANEL_X + 10 + GRAPH_FRAMES - static_cast<int>(frameTimes.size());
+    for (size_t i = 0; i < frameTimes.size(); i++) {
+        int height = static_cast<int>(std::min(frameTimes[i] / GRAPH_MS_RANGE, 1.0) * GRAPH_H);
+        rects.push_back(SDL_Rect{graphLeft + static_cast<int>(i), graphBottom - height, 1, height});
+    }
+    SDL_SetRenderDrawColor(renderer, 80, 200, 120, 255);
+    SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+
+    // 60 and 30 fps reference lines
+    SDL_SetRenderDrawColor(renderer, 200, 200, 80, 255);
+    int line60 = graphBottom - static_cast<int>(1000.0 / 60 / GRAPH_MS_RANGE * GRAPH_H);
+    int line30 = graphBottom - static_cast<int>(1000.0 / 30 / GRAPH_MS_RANGE * GRAPH_H);
+    SDL_RenderDrawLine(renderer, PANEL_X + 10, line60, PANEL_X + 10 + GRAPH_FRAMES, line60);
+    SDL_RenderDrawLine(renderer, PANEL_X + 10, line30, PANEL_X + 10 + GRAPH_FRAMES, line30);
+
+    rects.clear();
+    char line[96];
+    double lastFrame = frameTimes.empty() ? 0 : frameTimes.back();
+    int y = graphBottom + 8;
+    std::snprintf(line, sizeof(line), "FRAME %.1f MS  %.0f FPS", lastFrame, lastFrame > 0 ? 1000 / lastFrame : 0.0);
+    drawText(PANEL_X + 10, y, line, 2);
+    y += 14;
+    std::snprintf(line, sizeof(line), "PHYSICS %d STEPS/TICK  BODIES %s", snapshot.physicsSteps,
+                  compact(static_cast<double>(snapshot.bodyX.size())).c_str());
+    drawText(PANEL_X + 10, y, line, 2);
+    y += 14;
+    drawText(PANEL_X + 10, y, "WARP " + compact(achievedRatio) + "X / " + compact(requestedRatio) + "X", 2);
+    y += 16;
+
+    // Where the time goes: milliseconds per second spent in each scope
+    for (const ScopeCost& scope : scopes) {
+        std::snprintf(line, sizeof(line), "%-16.16s %6.1f MS/S", scope.name, scope.msPerSecond);
+        drawText(PANEL_X + 10, y, line, 1);
+        y += 8;
+        if (y > PANEL_Y + PANEL_H - 8) break;
+    }
+
+    SDL_SetRenderDrawColor(renderer, 230, 230, 230, 255);
+    SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+}
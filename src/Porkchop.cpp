@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../include/Porkchop.h"
+#include "../include/Constants.h"
+#include "../include/Kepler.h"
+#include "../include/Lambert.h"
+
+namespace {
+
+const size_t ROW_GRAIN = 4; // Grid rows per task
+
+// Period of the orbit through this state, or of a circular orbit at its radius if unbound
+double orbitalPeriod(const Vector2D& position, const Vector2D& velocity, double mu) {
+    double r = position.magnitude();
+    double v = velocity.magnitude();
+    double inverseA = 2 / r - v * v / mu;
+    double a = inverseA > 0 ? 1 / inverseA : r;
+    return 2 * M_PI * std::sqrt(a * a * a / mu);
+}
+
+}
+
+bool PorkchopPlot::setCentral(const BodyStore& bodies, size_t to) {
+    central = -1;
+    double strongest = 0;
+    for (size_t k = 0; k < bodies.size(); k++) {
+        if (!(bodies.mass[k] > bodies.mass[to])) continue;
+        Vector2D d = bodies.position(k) - bodies.position(to);
+        double d2 = d.x * d.x + d.y * d.y;
+        if (d2 > 0 && bodies.mass[k] / d2 > strongest) {
+            strongest = bodies.mass[k] / d2;
+            central = static_cast<int32_t>(k);
+        }
+    }
+    if (central < 0) return false;
+    mu = GRAVITATIONAL_CONSTANT * bodies.mass[central];
+    arrivalPosition = bodies.position(to) - bodies.position(central);
+    arrivalVelocity = bodies.velocity(to) - bodies.velocity(central);
+    return true;
+}
+
+bool PorkchopPlot::setBodies(const BodyStore& bodies, size_t from, size_t to, double now) {
+    if (from >= bodies.size() || to >= bodies.size() || !setCentral(bodies, to) || from == static_cast<size_t>(central)) {
+        return false;
+    }
+    departurePosition = bodies.position(from) - bodies.position(central);
+    departureVelocity = bodies.velocity(from) - bodies.velocity(central);
+    epoch = now;
+    return true;
+}
+
+bool PorkchopPlot::setShip(const BodyStore& bodies, const Vector2D& position, const Vector2D& velocity, size_t to, double now) {
+    if (to >= bodies.size() || !setCentral(bodies, to)) return false;
+    departurePosition = position - bodies.position(central);
+    departureVelocity = velocity - bodies.velocity(central);
+    epoch = now;
+    return true;
+}
+
+void PorkchopPlot::defaultWindows(size_t size) {
+    departures = arrivals = size;
+
+    // Departures over one synodic period; orbits with (nearly) the same period
+    // line up only rarely, so cap it
+    double departurePeriod = orbitalPeriod(departurePosition, departureVelocity, mu);
+    double arrivalPeriod = orbitalPeriod(arrivalPosition, arrivalVelocity, mu);
+    double beat = std::abs(1 / departurePeriod - 1 / arrivalPeriod);
+    double longest = std::max(departurePeriod, arrivalPeriod);
+    double synodic = beat > 0 ? std::min(1 / beat, 4 * longest) : 4 * longest;
+
+    double transferA = (departurePosition.magnitude() + arrivalPosition.magnitude()) / 2;
+    double hohmann = M_PI * std::sqrt(transferA * transferA * transferA / mu);
+
+    departureStart = epoch;
+    departureEnd = epoch + synodic;
+    arrivalStart = epoch + hohmann / 4;
+    arrivalEnd = departureEnd + 2 * hohmann;
+}
+
+double PorkchopPlot::departureTime(size_t i) const {
+    return departures > 1 ? departureStart + (departureEnd - departureStart) * i / (departures - 1) : departureStart;
+}
+
+double PorkchopPlot::arrivalTime(size_t j) const {
+    return arrivals > 1 ? arrivalStart + (arrivalEnd - arrivalStart) * j / (arrivals - 1) : arrivalStart;
+}
+
+void PorkchopPlot::compute(ThreadPool* pool) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // Each orbit once per grid time, not once per cell
+    auto ephemeris = [&](const Vector2D& position, const Vector2D& velocity, size_t count, bool departing,
+                         std::vector<Vector2D>& at, std::vector<Vector2D>& velocityAt) {
+        at.resize(count);
+        velocityAt.resize(count);
+        for (size_t k = 0; k < count; k++) {
+            Vector2D p = position, v = velocity;
+            double time = departing ? departureTime(k) : arrivalTime(k);
+            if (!Kepler::propagate(p, v, mu, time - epoch)) p = v = Vector2D(nan, nan);
+            at[k] = p;
+            velocityAt[k] = v;
+        }
+    };
+    ephemeris(departurePosition, departureVelocity, departures, true, departureAt, departureVelocityAt);
+    ephemeris(arrivalPosition, arrivalVelocity, arrivals, false, arrivalAt, arrivalVelocityAt);
+
+    // Transfers go the way the ship already goes round
+    const bool counterclockwise = departurePosition.x * departureVelocity.y - departurePosition.y * departureVelocity.x >= 0;
+
+    departureDeltaV.assign(departures * arrivals, nan);
+    arrivalDeltaV.assign(departures * arrivals, nan);
+    auto rows = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const double leave = departureTime(i);
+            double* departureRow = &departureDeltaV[i * arrivals];
+            double* arrivalRow = &arrivalDeltaV[i * arrivals];
+            for (size_t j = 0; j < arrivals; j++) {
+                Vector2D v1, v2;
+                if (!Lambert::solve(departureAt[i], arrivalAt[j], arrivalTime(j) - leave, mu, counterclockwise, v1, v2)) continue;
+                departureRow[j] = (v1 - departureVelocityAt[i]).magnitude();
+                arrivalRow[j] = (arrivalVelocityAt[j] - v2).magnitude();
+            }
+        }
+    };
+    if (pool) {
+        pool->parallelFor(departures, ROW_GRAIN, rows);
+    } else {
+        rows(0, departures);
+    }
+}
+
+bool PorkchopPlot::cheapest(size_t& i, size_t& j) const {
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t row = 0; row < departures; row++) {
+        for (size_t column = 0; column < arrivals; column++) {
+            double total = totalDeltaV(row, column);
+            if (total < best) {
+                best = total;
+                i = row;
+                j = column;
+            }
+        }
+    }
+    return best < std::numeric_limits<double>::infinity();
+}
+
+void PorkchopPlot::writeCsv(std::ostream& out) const {
+    out.precision(9);
+    out << "departure\\arrival";
+    for (size_t j = 0; j < arrivals; j++) out << ',' << arrivalTime(j);
+    out << '\n';
+    for (size_t i = 0; i < departures; i++) {
+        out << departureTime(i);
+        for (size_t j = 0; j < arrivals; j++) {
+            double total = totalDeltaV(i, j);
+            out << ',';
+            if (!std::isnan(total)) out << total;
+        }
+        out << '\n';
+    }
+}
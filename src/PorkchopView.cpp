@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/PorkchopView.h"
+#include "../include/Constants.h"
+
+namespace {
+
+const int PANEL_SIZE = 300; // Pixels, bottom right corner
+const int PANEL_MARGIN = 10;
+const double COLOR_RANGE = 8; // Totals from the cheapest to this many times it span the colors
+
+// Cheap to dear: pale yellow, red, deep purple
+Uint32 heatColor(double t) {
+    static const double stops[3][3] = {{255, 240, 120}, {220, 60, 60}, {40, 10, 60}};
+    t = std::min(std::max(t, 0.0), 1.0) * 2;
+    int k = std::min(static_cast<int>(t), 1);
+    double f = t - k;
+    Uint32 r = static_cast<Uint32>(stops[k][0] + (stops[k + 1][0] - stops[k][0]) * f);
+    Uint32 g = static_cast<Uint32>(stops[k][1] + (stops[k + 1][1] - stops[k][1]) * f);
+    Uint32 b = static_cast<Uint32>(stops[k][2] + (stops[k + 1][2] - stops[k][2]) * f);
+    return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+}
+
+PorkchopView::PorkchopView()
+    : computing(false), workingTarget(-1), finishedTarget(-1), fresh(false), texture(nullptr), textureWidth(0),
+      textureHeight(0), shownTarget(-1), cheapestX(-1), cheapestY(-1) {}
+
+PorkchopView::~PorkchopView() {
+    if (worker.joinable()) worker.join();
+    clear();
+}
+
+bool PorkchopView::compute(const PorkchopPlot& setup, int32_t target) {
+    if (computing) return false;
+    if (worker.joinable()) worker.join();
+
+    working = setup;
+    workingTarget = target;
+    computing = true;
+    worker = std::thread([this] {
+        working.compute(&pool);
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            std::swap(finished, working);
+            finishedTarget = workingTarget;
+            fresh = true;
+        }
+        computing = false;
+    });
+    return true;
+}
+
+void PorkchopView::clear() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    textureWidth = textureHeight = 0;
+    shownTarget = -1;
+}
+
+void PorkchopView::fillTexture(SDL_Renderer* renderer) {
+    std::lock_guard<std::mutex> lock(finishedMutex);
+    fresh = false;
+    shownTarget = finishedTarget;
+    const int width = static_cast<int>(finished.departures);
+    const int height = static_cast<int>(finished.arrivals);
+    if (width == 0 || height == 0) return;
+
+    if (!texture || width != textureWidth || height != textureHeight) {
+        if (texture) SDL_DestroyTexture(texture);
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+        textureWidth = width;
+        textureHeight = height;
+        if (!texture) return;
+    }
+
+    // Log scale from the cheapest transfer
+    size_t bestI = 0, bestJ = 0;
+    bool any = finished.cheapest(bestI, bestJ);
+    double cheapest = any ? finished.totalDeltaV(bestI, bestJ) : 0;
+    double span = std::log(COLOR_RANGE);
+    pixels.resize(static_cast<size_t>(width) * height);
+    for (int j = 0; j < height; j++) {
+        Uint32* row = &pixels[static_cast<size_t>(height - 1 - j) * width];
+        for (int i = 0; i < width; i++) {
+            double total = finished.totalDeltaV(i, j);
+            row[i] = std::isnan(total) || cheapest <= 0 ? 0xFF000000u : heatColor(std::log(total / cheapest) / span);
+        }
+    }
+    SDL_UpdateTexture(texture, nullptr, pixels.data(), width * static_cast<int>(sizeof(Uint32)));
+    cheapestX = any ? static_cast<int>(bestI) : -1;
+    cheapestY = any ? height - 1 - static_cast<int>(bestJ) : -1;
+}
+
+void PorkchopView::render(SDL_Renderer* renderer, int32_t target) {
+    bool refill;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        if (finishedTarget != target) return; // Still computing the plot for it
+        refill = fresh || shownTarget != target;
+    }
+    if (refill) fillTexture(renderer);
+    if (!texture) return;
+
+    SDL_Rect panel = {SCREEN_WIDTH - PANEL_SIZE - PANEL_MARGIN, SCREEN_HEIGHT - PANEL_SIZE - PANEL_MARGIN, PANEL_SIZE, PANEL_SIZE};
+    SDL_RenderCopy(renderer, texture, nullptr, &panel);
+    SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+    SDL_RenderDrawRect(renderer, &panel);
+
+    if (cheapestX >= 0) {
+        int x = panel.x + cheapestX * PANEL_SIZE / textureWidth;
+        int y = panel.y + cheapestY * PANEL_SIZE / textureHeight;
+        SDL_Rect marker = {x - 4, y - 4, 9, 9};
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+        SDL_RenderDrawRect(renderer, &marker);
+    }
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include "../include/Profiler.h"
+
+const size_t Profiler::CAPACITY;
+
+namespace {
+
+// Sequence is odd while a writer fills the slot and 2 * (index + 1) once event
+// number index is complete, so readers can tell torn or stale slots apart
+struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> durationNs{0};
+    std::atomic<uint32_t> thread{0};
+};
+
+std::atomic<bool> enabled{false};
+std::atomic<uint64_t> nextEvent{0};
+std::atomic<uint32_t> nextThread{0};
+std::unique_ptr<Slot[]> slots(new Slot[Profiler::CAPACITY]);
+
+uint32_t threadNumber() {
+    static thread_local uint32_t number = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+}
+
+void Profiler::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::record(const char* name, uint64_t startNs, uint64_t durationNs) {
+    uint64_t index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index % CAPACITY];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.thread.store(threadNumber(), std::memory_order_relaxed);
+    slot.sequence.store(2 * (index + 1), std::memory_order_release);
+}
+
+void Profiler::collect(std::vector<ProfileEvent>& out) {
+    out.clear();
+    uint64_t end = nextEvent.load(std::memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    for (uint64_t index = begin; index < end; index++) {
+        const Slot& slot = slots[index % CAPACITY];
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * (index + 1)) continue; // Still being written, or already reused
+
+        ProfileEvent event;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.startNs = slot.startNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        event.thread = slot.thread.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+        out.push_back(event);
+    }
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) {
+    std::vector<ProfileEvent> events;
+    collect(events);
+
+    uint64_t origin = events.empty() ? 0 : events.front().startNs;
+    for (const ProfileEvent& event : events) origin = std::min(origin, event.startNs);
+
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\": [";
+    for (size_t i = 0; i < events.size(); i++) {
+        const ProfileEvent& event = events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1"
+            << ", \"tid\": " << event.thread
+            << ", \"ts\": " << (event.startNs - origin) / 1000.0
+            << ", \"dur\": " << event.durationNs / 1000.0 << "}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    out.flags(flags);
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/QuadTree.h"
+#include "../include/GravityKernel.h"
+
+void QuadTree::build(const double* x, const double* y, const double* mass, const double* radius, size_t n) {
+    nodes.clear();
+    order.resize(n);
+    px.resize(n);
+    py.resize(n);
+    pmass.resize(n);
+    pradius.resize(n);
+    quadrant.resize(n);
+    tmpOrder.resize(n);
+    tmpX.resize(n);
+    tmpY.resize(n);
+    tmpMass.resize(n);
+    tmpRadius.resize(n);
+    if (n == 0) return;
+
+    // Square bounds enclosing every point
+    double minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (size_t i = 0; i < n; i++) {
+        order[i] = static_cast<uint32_t>(i);
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+    }
+    double halfSize = 0.5 * std::max(maxX - minX, maxY - minY);
+    halfSize = halfSize * 1.0001 + 1.0; // Keep points on the max edge inside
+
+    // Copy points into the working arrays, split() keeps them in tree order
+    for (size_t i = 0; i < n; i++) {
+        px[i] = x[i];
+        py[i] = y[i];
+        pmass[i] = mass[i];
+        pradius[i] = radius ? radius[i] : 0.0;
+    }
+
+    Node root;
+    root.centerX = 0.5 * (minX + maxX);
+    root.centerY = 0.5 * (minY + maxY);
+    root.halfSize = halfSize;
+    root.firstChild = -1;
+    root.first = 0;
+    root.count = static_cast<uint32_t>(n);
+    nodes.reserve(2 * n / LEAF_CAPACITY + 8);
+    nodes.push_back(root);
+    split(0, 0);
+}
+
+void QuadTree::split(int32_t nodeIndex, int depth) {
+    const uint32_t first = nodes[nodeIndex].first;
+    const uint32_t count = nodes[nodeIndex].count;
+
+    if (count <= static_cast<uint32_t>(LEAF_CAPACITY) || depth >= MAX_DEPTH) {
+        // Leaf: accumulate mass directly from the points
+        double m = 0, mx = 0, my = 0;
+        for (uint32_t k = first; k < first + count; k++) {
+            m += pmass[k];
+            mx += pmass[k] * px[k];
+            my += pmass[k] * py[k];
+        }
+        Node& node = nodes[nodeIndex];
+        node.mass = m;
+        node.comX = m > 0 ? mx / m : node.centerX;
+        node.comY = m > 0 ? my / m : node.centerY;
+        return;
+    }
+
+    const double cx = nodes[nodeIndex].centerX;
+    const double cy = nodes[nodeIndex].centerY;
+    const double childHalf = nodes[nodeIndex].halfSize * 0.5;
+
+    // Counting sort of the range into quadrants (0: -x-y, 1: +x-y, 2: -x+y, 3: +x+y)
+    uint32_t quadrantCount[4] = {0, 0, 0, 0};
+    for (uint32_t k = first; k < first + count; k++) {
+        uint8_t q = (px[k] >= cx ? 1 : 0) | (py[k] >= cy ? 2 : 0);
+        quadrant[k] = q;
+        quadrantCount[q]++;
+    }
+    uint32_t offset[4];
+    offset[0] = first;
+    for (int q = 1; q < 4; q++) offset[q] = offset[q - 1] + quadrantCount[q - 1];
+
+    uint32_t cursor[4] = {offset[0], offset[1], offset[2], offset[3]};
+    for (uint32_t k = first; k < first + count; k++) {
+        uint32_t dst = cursor[quadrant[k]]++;
+        tmpOrder[dst] = order[k];
+        tmpX[dst] = px[k];
+        tmpY[dst] = py[k];
+        tmpMass[dst] = pmass[k];
+        tmpRadius[dst] = pradius[k];
+    }
+    std::copy(tmpOrder.begin() + first, tmpOrder.begin() + first + count, order.begin() + first);
+    std::copy(tmpX.begin() + first, tmpX.begin() + first + count, px.begin() + first);
+    std::copy(tmpY.begin() + first, tmpY.begin() + first + count, py.begin() + first);
+    std::copy(tmpMass.begin() + first, tmpMass.begin() + first + count, pmass.begin() + first);
+    std::copy(tmpRadius.begin() + first, tmpRadius.begin() + first + count, pradius.begin() + first);
+
+    const int32_t firstChild = static_cast<int32_t>(nodes.size());
+    nodes[nodeIndex].firstChild = firstChild;
+    for (int q = 0; q < 4; q++) {
+        Node child;
+        child.centerX = cx + ((q & 1) ? childHalf : -childHalf);
+        child.centerY = cy + ((q & 2) ? childHalf : -childHalf);
+        child.halfSize = childHalf;
+        child.firstChild = -1;
+        child.first = offset[q];
+        child.count = quadrantCount[q];
+        nodes.push_back(child);
+    }
+
+    double m = 0, mx = 0, my = 0;
+    for (int q = 0; q < 4; q++) {
+        split(firstChild + q, depth + 1);
+        const Node& child = nodes[firstChild + q];
+        m += child.mass;
+        mx += child.mass * child.comX;
+        my += child.mass * child.comY;
+    }
+    Node& node = nodes[nodeIndex];
+    node.mass = m;
+    node.comX = m > 0 ? mx / m : node.centerX;
+    node.comY = m > 0 ? my / m : node.centerY;
+}
+
+void QuadTree::accumulate(double tx, double ty, double theta, GravityKernel::Path path, double& ax, double& ay) const {
+    if (nodes.empty()) return;
+
+    // Accepted far nodes are gathered and summed in one kernel call at the end
+    static thread_local std::vector<double> farX, farY, farMass, farRadius;
+    farX.clear();
+    farY.clear();
+    farMass.clear();
+
+    // Traversal stack; a quadtree of MAX_DEPTH pushes at most 3 siblings per level
+    int32_t pending[4 * MAX_DEPTH + 4];
+    int top = 0;
+    pending[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[pending[--top]];
+        if (node.count == 0) continue;
+
+        if (node.firstChild < 0) {
+            // Leaf: exact sum over its points, which are contiguous in tree order
+            GravityKernel::accumulate(path, &px[node.first], &py[node.first], &pmass[node.first], &pradius[node.first],
+                                      node.count, tx, ty, ax, ay);
+            continue;
+        }
+
+        double dx = node.comX - tx;
+        double dy = node.comY - ty;
+        double distSq = dx*dx + dy*dy;
+        // Opening test d > s/theta + delta, where delta is the offset of the center
+        // of mass from the cell center (guards against lopsided cells)
+        double offX = node.comX - node.centerX;
+        double offY = node.comY - node.centerY;
+        double reach = 2 * node.halfSize / theta + std::sqrt(offX*offX + offY*offY);
+
+        if (theta > 0 && distSq > reach * reach) {
+            // Far enough away: treat the whole node as one point mass
+            farX.push_back(node.comX);
+            farY.push_back(node.comY);
+            farMass.push_back(node.mass);
+        } else {
+            for (int q = 3; q >= 0; q--) {
+                pending[top++] = node.firstChild + q;
+            }
+        }
+    }
+
+    // Point masses have no radius; the buffer only ever holds zeros
+    if (farRadius.size() < farX.size()) farRadius.resize(farX.size(), 0.0);
+    GravityKernel::accumulate(path, farX.data(), farY.data(), farMass.data(), farRadius.data(), farX.size(), tx, ty, ax, ay);
+}
+
+void QuadTree::query(double minX, double minY, double maxX, double maxY, double minNodeSize,
+                     std::vector<uint32_t>& points, std::vector<int32_t>& clusters) const {
+    if (nodes.empty()) return;
+
+    int32_t pending[4 * MAX_DEPTH + 4];
+    int top = 0;
+    pending[top++] = 0;
+
+    while (top > 0) {
+        int32_t nodeIndex = pending[--top];
+        const Node& node = nodes[nodeIndex];
+        if (node.count == 0) continue;
+
+        // Node square misses the rectangle
+        if (node.centerX + node.halfSize < minX || node.centerX - node.halfSize > maxX ||
+            node.centerY + node.halfSize < minY || node.centerY - node.halfSize > maxY) {
+            continue;
+        }
+
+        if (node.count > 1 && 2 * node.halfSize < minNodeSize) {
+            clusters.push_back(nodeIndex);
+        } else if (node.firstChild < 0) {
+            for (uint32_t k = node.first; k < node.first + node.count; k++) {
+                if (px[k] >= minX && px[k] <= maxX && py[k] >= minY && py[k] <= maxY) {
+                    points.push_back(k);
+                }
+            }
+        } else {
+            for (int q = 3; q >= 0; q--) {
+                pending[top++] = node.firstChild + q;
+            }
+        }
+    }
+}
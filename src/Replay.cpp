@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "../include/Replay.h"
+#include "../include/Simulation.h"
+#include "../include/StateFile.h"
+
+namespace {
+
+const char MAGIC[8] = {'S', 'S', 'I', 'M', 'R', 'P', 'L', 'Y'};
+const uint32_t VERSION = 1;
+
+enum ChunkType : uint32_t { KEYFRAME = 'K', COMMAND = 'C', END = 'E' };
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t deterministic;
+    uint64_t keyframeInterval;
+};
+
+struct CommandRecord {
+    uint64_t tick;
+    int32_t type;
+    uint32_t active;
+    double directionX, directionY;
+    double value;
+};
+
+struct EndRecord {
+    uint64_t tick;
+    uint64_t hash;
+};
+
+template <typename T>
+void writeRaw(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readRaw(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    if (out.is_open()) out.close(); // No end marker: the player treats the file as cut short
+}
+
+bool ReplayRecorder::start(Simulation& simulation, const std::string& outputPath, uint64_t interval) {
+    out.open(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to open " << outputPath << std::endl;
+        return false;
+    }
+    path = outputPath;
+    keyframeInterval = std::max<uint64_t>(interval, 1);
+
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.deterministic = simulation.deterministic ? 1 : 0;
+    header.keyframeInterval = keyframeInterval;
+    writeRaw(out, header);
+
+    log.clear();
+    simulation.commandLog = &log;
+    writeKeyframe(simulation);
+    return true;
+}
+
+void ReplayRecorder::beforeTick(Simulation& simulation) {
+    if (!out.is_open()) return;
+    flushCommands();
+    if (simulation.tick % keyframeInterval == 0 && simulation.tick != lastKeyframeTick) writeKeyframe(simulation);
+}
+
+void ReplayRecorder::finish(Simulation& simulation) {
+    if (!out.is_open()) return;
+    flushCommands();
+    simulation.commandLog = nullptr;
+
+    writeRaw(out, static_cast<uint32_t>(END));
+    writeRaw(out, EndRecord{simulation.tick, ReplayPlayer::stateHash(simulation)});
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Failed to write " << path << std::endl;
+    } else {
+        std::cout << "Recorded " << path << " up to tick " << simulation.tick << std::endl;
+    }
+}
+
+void ReplayRecorder::flushCommands() {
+    for (const SimCommand& command : log) {
+        writeRaw(out, static_cast<uint32_t>(COMMAND));
+        writeRaw(out, CommandRecord{command.tick, static_cast<int32_t>(command.type), command.active ? 1u : 0u,
+                                    command.direction.x, command.direction.y, command.value});
+    }
+    log.clear();
+}
+
+void ReplayRecorder::writeKeyframe(const Simulation& simulation) {
+    StateFile::encode(simulation, keyframeBytes);
+    lastKeyframeTick = simulation.tick;
+    writeRaw(out, static_cast<uint32_t>(KEYFRAME));
+    writeRaw(out, static_cast<uint64_t>(simulation.tick));
+    writeRaw(out, static_cast<uint64_t>(keyframeBytes.size()));
+    out.write(keyframeBytes.data(), static_cast<std::streamsize>(keyframeBytes.size()));
+    // A crash mid-session still leaves every complete keyframe readable
+    out.flush();
+}
+
+bool ReplayPlayer::load(const std::string& replayPath) {
+    std::ifstream in(replayPath, std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open " << replayPath << std::endl;
+        return false;
+    }
+    FileHeader header;
+    if (!readRaw(in, header) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << replayPath << ": not a replay file" << std::endl;
+        return false;
+    }
+    if (header.version != VERSION) {
+        std::cerr << replayPath << ": replay version " << header.version << ", expected " << VERSION << std::endl;
+        return false;
+    }
+
+    in.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(sizeof(header));
+
+    path = replayPath;
+    deterministic = header.deterministic != 0;
+    keyframeInterval = header.keyframeInterval;
+    keyframes.clear();
+    commands.clear();
+    endHash = 0;
+
+    uint32_t type;
+    bool ended = false;
+    while (!ended && readRaw(in, type)) {
+        if (type == KEYFRAME) {
+            KeyframeEntry entry;
+            if (!readRaw(in, entry.tick) || !readRaw(in, entry.size)) break;
+            entry.offset = static_cast<uint64_t>(in.tellg());
+            if (entry.offset + entry.size > fileSize) break; // Cut off mid-keyframe
+            in.seekg(static_cast<std::streamoff>(entry.size), std::ios::cur);
+            keyframes.push_back(entry);
+        } else if (type == COMMAND) {
+            CommandRecord record;
+            if (!readRaw(in, record)) break;
+            if (record.type < 0 || record.type > static_cast<int32_t>(SimCommand::Type::LaunchShip)) {
+                std::cerr << replayPath << ": unknown command type " << record.type << ", reading what came before it"
+                          << std::endl;
+                break;
+            }
+            SimCommand command;
+            command.type = static_cast<SimCommand::Type>(record.type);
+            command.active = record.active != 0;
+            command.direction = Vector2D(record.directionX, record.directionY);
+            command.value = record.value;
+            command.tick = record.tick;
+            commands.push_back(command);
+        } else if (type == END) {
+            EndRecord record;
+            if (!readRaw(in, record)) break;
+            endTick = record.tick;
+            endHash = record.hash;
+            ended = true;
+        } else {
+            std::cerr << replayPath << ": corrupt chunk, reading what came before it" << std::endl;
+            break;
+        }
+    }
+
+    if (keyframes.empty()) {
+        std::cerr << replayPath << ": no keyframes" << std::endl;
+        return false;
+    }
+    startTick = keyframes.front().tick;
+    if (!ended) {
+        // Cut short: everything up to the last complete chunk is still playable
+        endTick = std::max(keyframes.back().tick, commands.empty() ? 0 : commands.back().tick + 1);
+        std::cerr << replayPath << ": no end marker, playable up to tick " << endTick << std::endl;
+    }
+    return true;
+}
+
+bool ReplayPlayer::seek(Simulation& simulation, uint64_t target) {
+    target = std::min(std::max(target, startTick), endTick);
+
+    // Nearest keyframe at or before the target
+    auto after = std::upper_bound(keyframes.begin(), keyframes.end(), target,
+                                  [](uint64_t tick, const KeyframeEntry& entry) { return tick < entry.tick; });
+    const KeyframeEntry& keyframe = *(after - 1);
+
+    std::ifstream in(path, std::ios::binary);
+    keyframeBytes.resize(static_cast<size_t>(keyframe.size));
+    in.seekg(static_cast<std::streamoff>(keyframe.offset));
+    if (!in.read(keyframeBytes.data(), static_cast<std::streamsize>(keyframeBytes.size()))) {
+        std::cerr << path << ": failed to read the keyframe at tick " << keyframe.tick << std::endl;
+        return false;
+    }
+    simulation.setDeterministic(deterministic);
+    if (!StateFile::decode(simulation, keyframeBytes.data(), keyframeBytes.size(), path)) return false;
+
+    // The keyframe precedes its tick's commands, so those are replayed too.
+    // Older recordings also logged session-only commands; re-running a SaveState
+    // would overwrite the quicksave.
+    for (const SimCommand& command : commands) {
+        if (command.tick >= keyframe.tick && command.changesPhysics()) simulation.queueCommand(command);
+    }
+    while (simulation.tick < target) {
+        simulation.runTick();
+    }
+    return true;
+}
+
+uint64_t ReplayPlayer::stateHash(const Simulation& simulation) {
+    // writeState prints every double with round-trip precision, so equal text means equal bits
+    std::ostringstream state;
+    simulation.writeState(state);
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (char c : state.str()) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
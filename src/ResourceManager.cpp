@@ -0,0 +1,195 @@
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "../include/ResourceManager.h"
+
+const int ATLAS_WIDTH = 1024; // Grows to fit a wider sprite
+const int ATLAS_PADDING = 1; // Transparent gap so filtering doesn't bleed between sprites
+
+ResourceManager::ResourceManager() : renderer(nullptr), atlasTexture(nullptr), atlasW(0), atlasH(0), dirty(false) {}
+
+ResourceManager::~ResourceManager() {
+    clear();
+}
+
+void ResourceManager::setRenderer(SDL_Renderer* target) {
+    renderer = target;
+    dirty = true;
+}
+
+SpriteHandle ResourceManager::sprite(const std::string& path) {
+    auto found = entries.find(path);
+    if (found != entries.end()) {
+        SpriteHandle existing = found->second.sprite.lock();
+        if (existing) return existing;
+    }
+
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded) {
+        std::cerr << "Failed to load image: " << path << std::endl;
+        return nullptr;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface) {
+        std::cerr << "Failed to convert image: " << path << std::endl;
+        return nullptr;
+    }
+    return addSurface(path, surface);
+}
+
+SpriteHandle ResourceManager::asteroidSprite() {
+    const std::string key = "procedural:asteroid";
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        SpriteHandle existing = found->second.sprite.lock();
+        if (existing) return existing;
+    }
+
+    const int diameter = 32;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, diameter, diameter, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) {
+        std::cerr << "Failed to create asteroid sprite: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    // Radius wobbles with angle for an irregular outline; lit from the top left
+    SDL_LockSurface(surface);
+    const double center = diameter / 2.0;
+    for (int y = 0; y < diameter; y++) {
+        uint8_t* row = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+        for (int x = 0; x < diameter; x++) {
+            double dx = x + 0.5 - center;
+            double dy = y + 0.5 - center;
+            double dist = std::sqrt(dx*dx + dy*dy);
+            double angle = std::atan2(dy, dx);
+            double edge = 12 + 2.5 * std::sin(3 * angle + 1) + 1.5 * std::sin(5 * angle + 2);
+            double coverage = std::min(std::max(edge - dist, 0.0), 1.0);
+            double light = 0.55 + 0.35 * (-(dx + dy) / (1.4142 * edge));
+            uint8_t shade = static_cast<uint8_t>(std::min(std::max(light, 0.2), 1.0) * 200);
+
+            uint8_t* p = row + x * 4;
+            p[0] = shade;
+            p[1] = shade;
+            p[2] = static_cast<uint8_t>(shade * 0.9);
+            p[3] = static_cast<uint8_t>(coverage * 255 + 0.5);
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return addSurface(key, surface);
+}
+
+SpriteHandle ResourceManager::addSurface(const std::string& key, SDL_Surface* surface) {
+    // An expired entry with the same key still holds its old surface
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        SDL_FreeSurface(found->second.surface);
+        entries.erase(found);
+    }
+
+    std::shared_ptr<Sprite> sprite = std::make_shared<Sprite>();
+    sprite->region = SDL_Rect{0, 0, surface->w, surface->h};
+    entries[key] = Entry{surface, sprite};
+    dirty = true;
+    return sprite;
+}
+
+SDL_Texture* ResourceManager::atlas() {
+    if (!dirty) {
+        // Repack when a sprite lost its last handle
+        for (const auto& entry : entries) {
+            if (entry.second.sprite.expired()) {
+                dirty = true;
+                break;
+            }
+        }
+    }
+    if (dirty) repack();
+    return atlasTexture;
+}
+
+void ResourceManager::repack() {
+    dirty = false;
+    if (atlasTexture) {
+        SDL_DestroyTexture(atlasTexture);
+        atlasTexture = nullptr;
+    }
+    atlasW = atlasH = 0;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.sprite.expired()) {
+            SDL_FreeSurface(it->second.surface);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (entries.empty() || !renderer) return;
+
+    // Shelf packing, tallest first
+    std::vector<Entry*> order;
+    int width = 0;
+    for (auto& entry : entries) {
+        order.push_back(&entry.second);
+        width = std::max(width, entry.second.surface->w + ATLAS_PADDING);
+    }
+    std::sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) {
+        return a->surface->h > b->surface->h;
+    });
+    width = std::max(width, ATLAS_WIDTH);
+
+    int x = 0, y = 0, shelfHeight = 0;
+    for (Entry* entry : order) {
+        std::shared_ptr<Sprite> sprite = entry->sprite.lock();
+        int w = entry->surface->w;
+        int h = entry->surface->h;
+        if (x + w > width) {
+            x = 0;
+            y += shelfHeight + ATLAS_PADDING;
+            shelfHeight = 0;
+        }
+        sprite->region = SDL_Rect{x, y, w, h};
+        x += w + ATLAS_PADDING;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+    int height = y + shelfHeight;
+
+    SDL_Surface* packed = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!packed) {
+        std::cerr << "Failed to create sprite atlas: " << SDL_GetError() << std::endl;
+        return;
+    }
+    SDL_FillRect(packed, nullptr, 0);
+    for (Entry* entry : order) {
+        SDL_Rect region = entry->sprite.lock()->region;
+        // Copy alpha as-is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(entry->surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(entry->surface, nullptr, packed, &region);
+    }
+
+    atlasTexture = SDL_CreateTextureFromSurface(renderer, packed);
+    SDL_FreeSurface(packed);
+    if (!atlasTexture) {
+        std::cerr << "Failed to upload sprite atlas: " << SDL_GetError() << std::endl;
+        return;
+    }
+    SDL_SetTextureBlendMode(atlasTexture, SDL_BLENDMODE_BLEND);
+    atlasW = width;
+    atlasH = height;
+}
+
+void ResourceManager::clear() {
+    if (atlasTexture) {
+        SDL_DestroyTexture(atlasTexture);
+        atlasTexture = nullptr;
+    }
+    for (auto& entry : entries) {
+        SDL_FreeSurface(entry.second.surface);
+    }
+    entries.clear();
+    atlasW = atlasH = 0;
+    dirty = false;
+}
@@ -0,0 +1,447 @@
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "../include/ScenarioLoader.h"
+#include "../include/Simulation.h"
+#include "../include/Constants.h"
+
+namespace {
+
+// Fields of one line; keys and values point into the (modified) line buffer
+struct Field {
+    const char* key;
+    const char* value;
+    bool used;
+};
+
+class LineParser {
+public:
+    LineParser(const std::string& sourceName, Simulation& simulation) : sourceName(sourceName), simulation(simulation) {}
+
+    bool parseLine(std::string& line, size_t number) {
+        lineNumber = number;
+        fields.clear();
+
+        // Strip the comment, then split into words in place
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        char* cursor = &line[0];
+        char* directive = nullptr;
+        while (true) {
+            while (*cursor && std::isspace(static_cast<unsigned char>(*cursor))) cursor++;
+            if (!*cursor) break;
+            char* word = cursor;
+            while (*cursor && !std::isspace(static_cast<unsigned char>(*cursor))) cursor++;
+            if (*cursor) *cursor++ = '\0';
+
+            if (!directive) {
+                directive = word;
+                continue;
+            }
+            char* equals = std::strchr(word, '=');
+            if (!equals || equals == word) return error(std::string("expected key=value, got '") + word + "'");
+            *equals = '\0';
+            fields.push_back(Field{word, equals + 1, false});
+        }
+        if (!directive) return true;
+
+        bool ok;
+        if (std::strcmp(directive, "settings") == 0) {
+            ok = parseSettings();
+        } else if (std::strcmp(directive, "body") == 0) {
+            ok = parseBody();
+        } else if (std::strcmp(directive, "ship") == 0) {
+            ok = parseShip();
+        } else if (std::strcmp(directive, "belt") == 0) {
+            ok = parseBelt(false);
+        } else if (std::strcmp(directive, "ring") == 0) {
+            ok = parseBelt(true);
+        } else if (std::strcmp(directive, "fleet") == 0) {
+            ok = parseFleet();
+        } else {
+            return error(std::string("unknown directive '") + directive + "'");
+        }
+        if (!ok) return false;
+
+        for (const Field& field : fields) {
+            if (!field.used) return error(std::string("unknown field '") + field.key + "' for " + directive);
+        }
+        return true;
+    }
+
+private:
+    const std::string& sourceName;
+    Simulation& simulation;
+    size_t lineNumber = 0;
+    std::vector<Field> fields;
+    std::unordered_map<std::string, size_t> namedBodies;
+
+    bool error(const std::string& message) const {
+        std::cerr << sourceName << ":" << lineNumber << ": " << message << std::endl;
+        return false;
+    }
+
+    const char* find(const char* key) {
+        for (Field& field : fields) {
+            if (std::strcmp(field.key, key) == 0) {
+                field.used = true;
+                return field.value;
+            }
+        }
+        return nullptr;
+    }
+
+    // Leaves value untouched when the key is absent
+    bool number(const char* key, double& value) {
+        const char* text = find(key);
+        if (!text) return true;
+        char* end;
+        errno = 0;
+        double parsed = std::strtod(text, &end);
+        if (end == text || *end || errno == ERANGE || !std::isfinite(parsed)) {
+            return error(std::string("bad number for ") + key + ": '" + text + "'");
+        }
+        value = parsed;
+        return true;
+    }
+
+    bool required(const char* key, double& value) {
+        if (!hasField(key)) return error(std::string("missing ") + key);
+        return number(key, value);
+    }
+
+    bool count(const char* key, size_t& value) {
+        double parsed = static_cast<double>(value);
+        if (!number(key, parsed)) return false;
+        if (parsed < 0 || parsed != std::floor(parsed) || parsed > 1e9) {
+            return error(std::string(key) + " must be a whole number");
+        }
+        value = static_cast<size_t>(parsed);
+        return true;
+    }
+
+    bool flag(const char* key, bool& value) {
+        const char* text = find(key);
+        if (!text) return true;
+        if (std::strcmp(text, "1") == 0) {
+            value = true;
+        } else if (std::strcmp(text, "0") == 0) {
+            value = false;
+        } else {
+            return error(std::string(key) + " must be 0 or 1");
+        }
+        return true;
+    }
+
+    // MIN:MAX, or a single value for both
+    bool range(const char* key, double& low, double& high) {
+        const char* text = find(key);
+        if (!text) return true;
+        char* end;
+        low = std::strtod(text, &end);
+        if (end == text) return error(std::string("bad range for ") + key);
+        if (*end == ':') {
+            const char* second = end + 1;
+            high = std::strtod(second, &end);
+            if (end == second) return error(std::string("bad range for ") + key);
+        } else {
+            high = low;
+        }
+        if (*end || !(low > 0) || high < low || !std::isfinite(high)) {
+            return error(std::string(key) + " must be positive, written MIN:MAX");
+        }
+        return true;
+    }
+
+    bool hasField(const char* key) const {
+        for (const Field& field : fields) {
+            if (std::strcmp(field.key, key) == 0) return true;
+        }
+        return false;
+    }
+
+    bool bodyIndex(const char* key, size_t& index) {
+        const char* name = find(key);
+        if (!name) return error(std::string("missing ") + key);
+        auto it = namedBodies.find(name);
+        if (it == namedBodies.end()) return error(std::string("no body named '") + name + "' above this line");
+        index = it->second;
+        return true;
+    }
+
+    // x/y/vx/vy, or a prograde circular orbit given by around/distance/angle
+    bool placement(double mass, Vector2D& position, Vector2D& velocity, int32_t& parent) {
+        parent = -1;
+        if (!hasField("around")) {
+            return number("x", position.x) && number("y", position.y) && number("vx", velocity.x) && number("vy", velocity.y);
+        }
+        size_t center;
+        double distance = 0, angle = 0;
+        if (!bodyIndex("around", center) || !required("distance", distance) || !number("angle", angle)) return false;
+        if (distance <= 0) return error("distance must be positive");
+
+        const BodyStore& bodies = simulation.bodies;
+        double radians = angle * M_PI / 180;
+        double speed = std::sqrt(GRAVITATIONAL_CONSTANT * (bodies.mass[center] + mass) / distance);
+        Vector2D direction(std::cos(radians), std::sin(radians));
+        position = bodies.position(center) + direction * distance;
+        velocity = bodies.velocity(center) + Vector2D(-direction.y, direction.x) * speed;
+        parent = static_cast<int32_t>(center);
+        return true;
+    }
+
+    bool parseSettings() {
+        double warp = simulation.timeWarpFactor, theta = simulation.gravity.getTheta();
+        if (!number("warp", warp) || !number("theta", theta)) return false;
+        if (warp <= 0) return error("warp must be positive");
+        simulation.timeWarpFactor = warp;
+        simulation.gravity.setTheta(theta);
+        if (!flag("collisions", simulation.collisionsEnabled)) return false;
+
+        if (const char* mode = find("gravity")) {
+            if (std::strcmp(mode, "exact") == 0) {
+                simulation.gravity.setMode(GravitySolver::Mode::Exact);
+            } else if (std::strcmp(mode, "barnes-hut") == 0) {
+                simulation.gravity.setMode(GravitySolver::Mode::BarnesHut);
+            } else {
+                return error(std::string("unknown gravity mode '") + mode + "'");
+            }
+        }
+        return true;
+    }
+
+    bool parseBody() {
+        double mass = 0, radius = 0, size = 0;
+        Vector2D position, velocity;
+        int32_t center;
+        bool rails = false;
+        if (!required("mass", mass) || !required("radius", radius) || !number("size", size) || !flag("rails", rails) ||
+            !placement(mass, position, velocity, center)) {
+            return false;
+        }
+        if (mass <= 0 || radius <= 0) return error("mass and radius must be positive");
+        if (rails && center < 0) return error("rails=1 needs around=NAME");
+
+        const char* sprite = find("sprite");
+        size_t index = simulation.addBody(mass, radius, position, velocity, sprite ? sprite : "", static_cast<int>(size));
+        if (rails) simulation.bodies.setRailsParent(index, center);
+
+        if (const char* name = find("name")) {
+            if (!namedBodies.emplace(name, index).second) return error(std::string("duplicate body name '") + name + "'");
+        }
+        return true;
+    }
+
+    bool parseShip() {
+        if (simulation.ship) return error("only one ship is supported");
+        double mass = 0, fuel = 0, power = 0;
+        Vector2D position, velocity;
+        int32_t center;
+        if (!required("mass", mass) || !number("fuel", fuel) || !number("power", power) ||
+            !placement(mass, position, velocity, center)) {
+            return false;
+        }
+        if (mass <= 0) return error("mass must be positive");
+        auto ship = std::make_shared<Spacecraft>(mass, position, velocity, fuel, power);
+
+        if (const char* name = find("integrator")) {
+            IntegratorType type;
+            if (!Integrator::fromName(name, type)) return error(std::string("unknown integrator '") + name + "'");
+            ship->setIntegrator(type);
+        }
+        // Error tolerance for the adaptive integrator, max substep for the fixed-step ones
+        double tolerance = 0, maxStep = 0;
+        size_t trail = ship->orbitTrail.capacity();
+        if (!number("tolerance", tolerance) || !number("maxstep", maxStep) || !count("trail", trail) ||
+            !flag("conics", ship->patchedConics)) {
+            return false;
+        }
+        if (tolerance > 0) {
+            if (auto* adaptive = dynamic_cast<DormandPrinceIntegrator*>(ship->integrator.get())) {
+                adaptive->errorTolerance = tolerance;
+            }
+        }
+        if (maxStep > 0) {
+            if (auto* fixed = dynamic_cast<FixedStepIntegrator*>(ship->integrator.get())) fixed->maxStep = maxStep;
+        }
+        ship->setTrailCapacity(trail);
+
+        simulation.ship = ship;
+        return true;
+    }
+
+    bool parseBelt(bool ring) {
+        BeltSpec spec;
+        spec.rails = ring; // Ring particles are light and many; keep them off the N-body integrator
+        double seed = static_cast<double>(spec.seed);
+        if (!bodyIndex("around", spec.parent) || !count("count", spec.count) ||
+            !required("inner", spec.innerRadius) || !required("outer", spec.outerRadius) ||
+            !range("mass", spec.minMass, spec.maxMass) || !range("radius", spec.minRadius, spec.maxRadius) ||
+            !number("eccentricity", spec.maxEccentricity) || !number("seed", seed) || !flag("rails", spec.rails)) {
+            return false;
+        }
+        if (spec.innerRadius <= 0 || spec.outerRadius < spec.innerRadius) return error("need 0 < inner <= outer");
+        if (spec.maxEccentricity < 0 || spec.maxEccentricity >= 1) return error("eccentricity must be in [0, 1)");
+        spec.seed = static_cast<uint64_t>(seed);
+        ScenarioLoader::generateBelt(simulation, spec);
+        return true;
+    }
+
+    bool parseFleet() {
+        FleetSpec spec;
+        double seed = static_cast<double>(spec.seed);
+        double size = spec.renderSize;
+        if (!bodyIndex("around", spec.parent) || !count("count", spec.count) ||
+            !required("inner", spec.innerRadius) || !required("outer", spec.outerRadius) ||
+            !range("mass", spec.minMass, spec.maxMass) || !number("eccentricity", spec.maxEccentricity) ||
+            !number("fuel", spec.fuel) || !number("thrust", spec.thrust) || !number("size", size) ||
+            !number("seed", seed)) {
+            return false;
+        }
+        if (spec.innerRadius <= 0 || spec.outerRadius < spec.innerRadius) return error("need 0 < inner <= outer");
+        if (spec.maxEccentricity < 0 || spec.maxEccentricity >= 1) return error("eccentricity must be in [0, 1)");
+        if (spec.fuel < 0 || spec.thrust < 0) return error("fuel and thrust can't be negative");
+        if (size < 1 || size > 255) return error("size must be 1 to 255 pixels");
+        if (simulation.fleet.size() + spec.count > UINT32_MAX) return error("too many ships");
+        spec.renderSize = static_cast<int>(size);
+        spec.seed = static_cast<uint64_t>(seed);
+        ScenarioLoader::generateFleet(simulation, spec);
+        return true;
+    }
+};
+
+// Position and velocity on the conic with semi-major axis a and eccentricity e
+// around a body at center (mu = G * total mass), at angle theta from it
+void conicState(Vector2D center, Vector2D centerVelocity, double mu, double a, double e, double theta,
+                double trueAnomaly, Vector2D& position, Vector2D& velocity) {
+    double p = a * (1 - e * e);
+    double r = p / (1 + e * std::cos(trueAnomaly));
+    double h = std::sqrt(mu / p);
+    Vector2D radial(std::cos(theta), std::sin(theta));
+    Vector2D tangential(-radial.y, radial.x);
+    position = center + radial * r;
+    velocity = centerVelocity + radial * (h * e * std::sin(trueAnomaly)) +
+               tangential * (h * (1 + e * std::cos(trueAnomaly)));
+}
+
+void clearSimulation(Simulation& simulation) {
+    simulation.bodies.clear();
+    simulation.bodyInfo.clear();
+    simulation.ship.reset();
+    simulation.fleet.clear();
+    simulation.collisionsEnabled = true;
+    simulation.tick = 0;
+    simulation.simTime = 0;
+    simulation.lastTickSteps = 0;
+    simulation.shipDrift.reset();
+    simulation.bodyDrift.reset();
+    simulation.gravity.invalidate();
+}
+
+}
+
+bool ScenarioLoader::load(Simulation& simulation, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    return parse(simulation, in, path);
+}
+
+bool ScenarioLoader::parse(Simulation& simulation, std::istream& in, const std::string& sourceName) {
+    clearSimulation(simulation);
+    LineParser parser(sourceName, simulation);
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        if (!parser.parseLine(line, ++lineNumber)) {
+            clearSimulation(simulation);
+            return false;
+        }
+    }
+    if (in.bad()) {
+        std::cerr << sourceName << ": read error" << std::endl;
+        clearSimulation(simulation);
+        return false;
+    }
+    return true;
+}
+
+void ScenarioLoader::generateBelt(Simulation& simulation, const BeltSpec& spec) {
+    BodyStore& bodies = simulation.bodies;
+    if (spec.parent >= bodies.size()) return;
+    bodies.reserve(bodies.size() + spec.count);
+    simulation.bodyInfo.reserve(simulation.bodyInfo.size() + spec.count);
+
+    const Vector2D center = bodies.position(spec.parent);
+    const Vector2D centerVelocity = bodies.velocity(spec.parent);
+    const double centerMass = bodies.mass[spec.parent];
+
+    std::mt19937_64 rng(spec.seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_real_distribution<double> turn(0, 2 * M_PI);
+    const double logMassRange = std::log(spec.maxMass / spec.minMass);
+    const double logRadiusRange = std::log(spec.maxRadius / spec.minRadius);
+    const double inner2 = spec.innerRadius * spec.innerRadius;
+    const double outer2 = spec.outerRadius * spec.outerRadius;
+
+    for (size_t k = 0; k < spec.count; k++) {
+        // Uniform surface density across the annulus
+        double a = std::sqrt(inner2 + (outer2 - inner2) * unit(rng));
+        double e = spec.maxEccentricity * unit(rng);
+        double theta = turn(rng);               // Angle of the body from the parent
+        double trueAnomaly = theta - turn(rng); // Minus a random argument of periapsis
+        double mass = spec.minMass * std::exp(logMassRange * unit(rng));
+        double radius = spec.minRadius * std::exp(logRadiusRange * unit(rng));
+
+        Vector2D position, velocity;
+        conicState(center, centerVelocity, GRAVITATIONAL_CONSTANT * (centerMass + mass), a, e, theta, trueAnomaly,
+                   position, velocity);
+
+        size_t index = bodies.add(mass, radius, position, velocity);
+        simulation.bodyInfo.push_back(BodyInfo{std::string(), 0});
+        if (spec.rails) bodies.setRailsParent(index, static_cast<int32_t>(spec.parent));
+    }
+    simulation.gravity.invalidate();
+}
+
+void ScenarioLoader::generateFleet(Simulation& simulation, const FleetSpec& spec) {
+    const BodyStore& bodies = simulation.bodies;
+    ShipStore& fleet = simulation.fleet;
+    if (spec.parent >= bodies.size()) return;
+    fleet.reserve(fleet.size() + spec.count);
+
+    const Vector2D center = bodies.position(spec.parent);
+    const Vector2D centerVelocity = bodies.velocity(spec.parent);
+    const double centerMass = bodies.mass[spec.parent];
+
+    std::mt19937_64 rng(spec.seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_real_distribution<double> turn(0, 2 * M_PI);
+    const double logMassRange = std::log(spec.maxMass / spec.minMass);
+    const double inner2 = spec.innerRadius * spec.innerRadius;
+    const double outer2 = spec.outerRadius * spec.outerRadius;
+
+    for (size_t k = 0; k < spec.count; k++) {
+        double a = std::sqrt(inner2 + (outer2 - inner2) * unit(rng));
+        double e = spec.maxEccentricity * unit(rng);
+        double theta = turn(rng);
+        double trueAnomaly = theta - turn(rng);
+        double mass = spec.minMass * std::exp(logMassRange * unit(rng));
+
+        Vector2D position, velocity;
+        conicState(center, centerVelocity, GRAVITATIONAL_CONSTANT * (centerMass + mass), a, e, theta, trueAnomaly,
+                   position, velocity);
+        fleet.spawn(mass, position, velocity, spec.fuel, spec.thrust,
+                    static_cast<uint8_t>(spec.renderSize));
+    }
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "../include/ShipStore.h"
+#include "../include/Constants.h"
+
+namespace {
+
+const size_t STEP_GRAIN = 1024; // Ships per work item
+
+}
+
+const size_t ShipStore::TRAIL_POINTS;
+
+void ShipStore::reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    vx.reserve(count);
+    vy.reserve(count);
+    ax.reserve(count);
+    ay.reserve(count);
+    mass.reserve(count);
+    fuel.reserve(count);
+    thrust.reserve(count);
+    thrustX.reserve(count);
+    thrustY.reserve(count);
+    burning.reserve(count);
+    trailPoints.reserve(count * TRAIL_POINTS * 2);
+    trailHead.reserve(count);
+    trailCount.reserve(count);
+    trailElapsed.reserve(count);
+    renderSize.reserve(count);
+    owner.reserve(count);
+}
+
+void ShipStore::clear() {
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    ax.clear();
+    ay.clear();
+    mass.clear();
+    fuel.clear();
+    thrust.clear();
+    thrustX.clear();
+    thrustY.clear();
+    burning.clear();
+    trailPoints.clear();
+    trailHead.clear();
+    trailCount.clear();
+    trailElapsed.clear();
+    renderSize.clear();
+    owner.clear();
+    slots.clear();
+    freeHead = UINT32_MAX;
+    layoutVersion++;
+}
+
+ShipHandle ShipStore::spawn(double shipMass, Vector2D pos, Vector2D vel, double shipFuel, double shipThrust, uint8_t size) {
+    uint32_t slot;
+    if (freeHead != UINT32_MAX) {
+        slot = freeHead;
+        freeHead = slots[slot].index;
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back(Slot{0, 0});
+    }
+    slots[slot].index = static_cast<uint32_t>(x.size());
+
+    x.push_back(pos.x);
+    y.push_back(pos.y);
+    vx.push_back(vel.x);
+    vy.push_back(vel.y);
+    ax.push_back(std::numeric_limits<double>::quiet_NaN());
+    ay.push_back(std::numeric_limits<double>::quiet_NaN());
+    mass.push_back(shipMass);
+    fuel.push_back(shipFuel);
+    thrust.push_back(shipThrust);
+    thrustX.push_back(0);
+    thrustY.push_back(0);
+    burning.push_back(0);
+    trailPoints.resize(trailPoints.size() + TRAIL_POINTS * 2, 0.0);
+    trailHead.push_back(0);
+    trailCount.push_back(0);
+    trailElapsed.push_back(trailInterval); // First step records a point
+    renderSize.push_back(size);
+    owner.push_back(slot);
+
+    layoutVersion++;
+    return ShipHandle{slot, slots[slot].generation};
+}
+
+bool ShipStore::despawn(ShipHandle handle) {
+    int64_t index = indexOf(handle);
+    if (index < 0) return false;
+
+    moveLastTo(static_cast<size_t>(index));
+
+    // Retire the handle and put the slot on the free list
+    Slot& slot = slots[handle.slot];
+    slot.generation++;
+    slot.index = freeHead;
+    freeHead = handle.slot;
+
+    layoutVersion++;
+    return true;
+}
+
+void ShipStore::moveLastTo(size_t index) {
+    size_t last = x.size() - 1;
+    if (index != last) {
+        x[index] = x[last];
+        y[index] = y[last];
+        vx[index] = vx[last];
+        vy[index] = vy[last];
+        ax[index] = ax[last];
+        ay[index] = ay[last];
+        mass[index] = mass[last];
+        fuel[index] = fuel[last];
+        thrust[index] = thrust[last];
+        thrustX[index] = thrustX[last];
+        thrustY[index] = thrustY[last];
+        burning[index] = burning[last];
+        std::memcpy(&trailPoints[index * TRAIL_POINTS * 2], &trailPoints[last * TRAIL_POINTS * 2],
+                    TRAIL_POINTS * 2 * sizeof(double));
+        trailHead[index] = trailHead[last];
+        trailCount[index] = trailCount[last];
+        trailElapsed[index] = trailElapsed[last];
+        renderSize[index] = renderSize[last];
+        owner[index] = owner[last];
+        slots[owner[index]].index = static_cast<uint32_t>(index);
+    }
+
+    x.pop_back();
+    y.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    ax.pop_back();
+    ay.pop_back();
+    mass.pop_back();
+    fuel.pop_back();
+    thrust.pop_back();
+    thrustX.pop_back();
+    thrustY.pop_back();
+    burning.pop_back();
+    trailPoints.resize(last * TRAIL_POINTS * 2);
+    trailHead.pop_back();
+    trailCount.pop_back();
+    trailElapsed.pop_back();
+    renderSize.pop_back();
+    owner.pop_back();
+}
+
+bool ShipStore::alive(ShipHandle handle) const {
+    return indexOf(handle) >= 0;
+}
+
+int64_t ShipStore::indexOf(ShipHandle handle) const {
+    if (handle.slot >= slots.size()) return -1;
+    const Slot& slot = slots[handle.slot];
+    // A free slot's index is a free-list link, but its generation has moved on
+    if (slot.generation != handle.generation) return -1;
+    return slot.index;
+}
+
+ShipHandle ShipStore::handleAt(size_t index) const {
+    uint32_t slot = owner[index];
+    return ShipHandle{slot, slots[slot].generation};
+}
+
+void ShipStore::setBurn(ShipHandle handle, bool active, Vector2D direction) {
+    int64_t index = indexOf(handle);
+    if (index < 0) return;
+    if (active) {
+        Vector2D unit = direction.normalized();
+        thrustX[index] = unit.x;
+        thrustY[index] = unit.y;
+    }
+    burning[index] = active && fuel[index] > 0;
+}
+
+Vector2D ShipStore::trailPoint(size_t index, size_t i) const {
+    size_t ring = (trailHead[index] + TRAIL_POINTS - trailCount[index] + i) % TRAIL_POINTS;
+    const double* point = &trailPoints[(index * TRAIL_POINTS + ring) * 2];
+    return Vector2D(point[0], point[1]);
+}
+
+void ShipStore::forEachChunk(ThreadPool* pool, const std::function<void(size_t, size_t)>& body) {
+    if (pool) {
+        pool->parallelFor(size(), STEP_GRAIN, body);
+    } else {
+        body(0, size());
+    }
+}
+
+void ShipStore::burn(size_t index, double seconds) {
+    // Same burn rate as the player's engine; the kick stops where the fuel does
+    double burnTime = std::min(seconds, fuel[index] / (thrust[index] * FUEL_PER_THRUST));
+    double deltaV = thrust[index] / mass[index] * burnTime;
+    vx[index] += thrustX[index] * deltaV;
+    vy[index] += thrustY[index] * deltaV;
+    fuel[index] -= thrust[index] * FUEL_PER_THRUST * burnTime;
+    if (fuel[index] <= 0 || burnTime < seconds) {
+        fuel[index] = 0;
+        burning[index] = 0;
+    }
+}
+
+void ShipStore::beginStep(const GravitySolver& gravity, double dt, ThreadPool* pool) {
+    if (x.empty()) return;
+    forEachChunk(pool, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            // Ships spawned since the last step have no acceleration yet
+            if (std::isnan(ax[i])) {
+                Vector2D g = gravity.accelerationAt(Vector2D(x[i], y[i]));
+                ax[i] = g.x;
+                ay[i] = g.y;
+            }
+
+            vx[i] += ax[i] * (dt/2);
+            vy[i] += ay[i] * (dt/2);
+            if (burning[i]) burn(i, dt/2);
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+        }
+    });
+}
+
+void ShipStore::endStep(const GravitySolver& gravity, double dt, ThreadPool* pool) {
+    if (x.empty()) return;
+    forEachChunk(pool, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            Vector2D g = gravity.accelerationAt(Vector2D(x[i], y[i]));
+            ax[i] = g.x;
+            ay[i] = g.y;
+
+            vx[i] += g.x * (dt/2);
+            vy[i] += g.y * (dt/2);
+            if (burning[i]) burn(i, dt/2);
+
+            // Time-decimated trail; the oldest point is overwritten once full
+            trailElapsed[i] += dt;
+            if (trailElapsed[i] >= trailInterval) {
+                trailElapsed[i] = 0;
+                double* point = &trailPoints[(i * TRAIL_POINTS + trailHead[i]) * 2];
+                point[0] = x[i];
+                point[1] = y[i];
+                trailHead[i] = static_cast<uint16_t>((trailHead[i] + 1) % TRAIL_POINTS);
+                if (trailCount[i] < TRAIL_POINTS) trailCount[i]++;
+            }
+        }
+    });
+}
@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include "../include/Simulation.h"
+#include "../include/Constants.h"
+#include "../include/Profiler.h"
+#include "../include/GravityKernel.h"
+
+Simulation::Simulation() : gravity(bodies) {
+    gravity.setThreadPool(&physicsPool);
+}
+
+size_t Simulation::addBody(double mass, double radius, Vector2D pos, Vector2D vel, const std::string& sprite, int renderSize) {
+    size_t index = bodies.add(mass, radius, pos, vel);
+    bodyInfo.push_back(BodyInfo{sprite, renderSize});
+    gravity.invalidate();
+    return index;
+}
+
+void Simulation::createDefaultScenario() {
+    // Create a star at the center
+    addBody(1.989e30, 696340000, Vector2D(0, 0), Vector2D(0, 0), "assets/star.png", 60);
+
+    // Create a planet in orbit
+    addBody(5.97e29, 6371000, Vector2D(1.5e13, 0), Vector2D(0, 29800), "assets/planet.png", 30);
+
+    createDefaultShip();
+}
+
+void Simulation::createDefaultShip() {
+    ship = std::make_shared<Spacecraft>(1000, Vector2D(1e13, 0), Vector2D(0, 1600), 1000, 50000);
+}
+
+void Simulation::runTick() {
+    PROFILE_SCOPE("sim tick");
+    applyDueCommands();
+
+    // Every tick advances the full requested simulated time
+    double frameTime = timeWarpFactor * TIME_STEP;
+
+    // Bodies take leapfrog steps of at most MAX_TIME_STEP (beyond the per-frame cap the
+    // steps grow instead); the spacecraft picks its own adaptive substeps within each
+    int numSteps = static_cast<int>(std::ceil(frameTime / MAX_TIME_STEP));
+    numSteps = std::max(1, std::min(numSteps, static_cast<int>(MAX_PHYSICS_STEPS_PER_FRAME)));
+    double dt = frameTime / numSteps;
+
+    for (int i = 0; i < numSteps; i++) {
+        updatePhysics(dt);
+    }
+    lastTickSteps = numSteps;
+    tick++;
+
+    if (diagnosticsEnabled) {
+        bodyDrift.record(DriftTracker::measureBodies(bodies));
+        if (tick % static_cast<uint64_t>(SIM_TICK_RATE) == 0) {
+            std::cout << Integrator::name(ship->integrator->type())
+                      << " ship energy drift " << shipDrift.energyDrift()
+                      << " angular momentum drift " << shipDrift.angularMomentumDrift()
+                      << " | bodies energy drift " << bodyDrift.energyDrift()
+                      << " angular momentum drift " << bodyDrift.angularMomentumDrift() << "\n";
+        }
+    }
+}
+
+void Simulation::advance(double seconds, double maxStep) {
+    if (!(seconds > 0) || !(maxStep > 0) || !std::isfinite(seconds / maxStep)) return;
+    uint64_t numSteps = static_cast<uint64_t>(std::ceil(seconds / maxStep));
+    double dt = seconds / numSteps;
+    for (uint64_t i = 0; i < numSteps; i++) {
+        updatePhysics(dt);
+    }
+}
+
+void Simulation::updatePhysics(double dt) {
+    PROFILE_SCOPE("physics step");
+
+    // Tree over the current body positions, shared by ship and body forces
+    {
+        PROFILE_SCOPE("gravity prepare");
+        gravity.prepare();
+    }
+
+    if (collisionsEnabled) collisions.beginStep(bodies, ship.get(), fleet);
+
+    // Fleet: half kick and drift against the forces at the start of the step
+    if (fleet.size()) {
+        PROFILE_SCOPE("fleet step");
+        fleet.beginStep(gravity, dt, &physicsPool);
+    }
+
+    // A coasting ship deep in one body's well follows a closed-form conic, so any
+    // warp costs O(1); otherwise integrate numerically
+    int primary = ship ? ship->coastingPrimary(gravity) : -1;
+    Vector2D relativePosition, relativeVelocity;
+    if (primary >= 0) {
+        relativePosition = ship->position - bodies.position(primary);
+        relativeVelocity = ship->velocity - bodies.velocity(primary);
+    } else if (ship) {
+        PROFILE_SCOPE("ship update");
+        ship->update(gravity, dt);
+    }
+
+    // Every body attracts every other body
+    {
+        PROFILE_SCOPE("step bodies");
+        gravity.stepBodies(dt);
+    }
+
+    // Fleet: second half kick in the field of the moved bodies
+    if (fleet.size()) {
+        PROFILE_SCOPE("fleet step");
+        fleet.endStep(gravity, dt, &physicsPool);
+    }
+
+    if (primary >= 0) {
+        ship->coast(gravity, primary, relativePosition, relativeVelocity, dt);
+    }
+
+    if (collisionsEnabled) {
+        PROFILE_SCOPE("collisions");
+        collisions.detect(bodies, ship.get(), fleet, &physicsPool);
+        resolveCollisions();
+    }
+
+    if (diagnosticsEnabled && ship) {
+        // Thrust changes the orbit on purpose, so measure drift from the last coast
+        if (ship->thrustActive) shipDrift.reset();
+        shipDrift.record(DriftTracker::measureOrbit(bodies, ship->position, ship->velocity));
+    }
+
+    simTime += dt;
+}
+
+void Simulation::resolveCollisions() {
+    if (collisions.contacts.empty()) return;
+
+    // Contacts are handled earliest first; an object that is gone takes part in no later ones
+    const size_t bodyCount = bodies.size();
+    std::vector<int32_t> replacement;
+    std::vector<ShipHandle> destroyed;
+    std::vector<uint8_t> gone(collisions.objectCount(), 0);
+    bool shipBounced = false;
+
+    for (const Contact& contact : collisions.contacts) {
+        if (gone[contact.a] || gone[contact.b]) continue;
+        CollisionSystem::Kind kindA = collisions.kindOf(contact.a);
+        CollisionSystem::Kind kindB = collisions.kindOf(contact.b);
+        uint32_t a = collisions.indexOf(contact.a);
+        uint32_t b = collisions.indexOf(contact.b);
+
+        if (kindA == CollisionSystem::Kind::Body && kindB == CollisionSystem::Kind::Body) {
+            // Perfectly inelastic merge into the heavier body, conserving mass, momentum and volume
+            uint32_t survivor = bodies.mass[b] > bodies.mass[a] ? b : a;
+            uint32_t absorbed = survivor == a ? b : a;
+            double m1 = bodies.mass[survivor], m2 = bodies.mass[absorbed];
+            double total = m1 + m2;
+            if (total > 0) {
+                bodies.setPosition(survivor, (bodies.position(survivor) * m1 + bodies.position(absorbed) * m2) * (1 / total));
+                bodies.setVelocity(survivor, (bodies.velocity(survivor) * m1 + bodies.velocity(absorbed) * m2) * (1 / total));
+            }
+            bodies.mass[survivor] = total;
+            bodies.radius[survivor] = std::cbrt(std::pow(bodies.radius[survivor], 3) + std::pow(bodies.radius[absorbed], 3));
+            if (bodyInfo[survivor].sprite.empty() && !bodyInfo[absorbed].sprite.empty()) {
+                bodyInfo[survivor] = bodyInfo[absorbed];
+            }
+            if (replacement.empty()) {
+                replacement.resize(bodyCount);
+                for (size_t i = 0; i < bodyCount; i++) replacement[i] = static_cast<int32_t>(i);
+            }
+            replacement[absorbed] = static_cast<int32_t>(survivor);
+            gone[absorbed] = 1;
+        } else if (kindA == CollisionSystem::Kind::Body || kindB == CollisionSystem::Kind::Body) {
+            uint32_t body = kindA == CollisionSystem::Kind::Body ? a : b;
+            uint32_t other = kindA == CollisionSystem::Kind::Body ? contact.b : contact.a;
+            if (collisions.kindOf(other) == CollisionSystem::Kind::Fleet) {
+                destroyed.push_back(fleet.handleAt(collisions.indexOf(other)));
+                gone[other] = 1;
+            } else if (!shipBounced) {
+                // Bounce off the body's surface, reflecting the velocity relative to it
+                Vector2D shipStart = collisions.startOf(other);
+                Vector2D bodyStart = collisions.startOf(body);
+                Vector2D shipAtContact = shipStart + (ship->position - shipStart) * contact.time;
+                Vector2D bodyAtContact = bodyStart + (bodies.position(body) - bodyStart) * contact.time;
+                Vector2D normal = (shipAtContact - bodyAtContact).normalized();
+                Vector2D relative = ship->velocity - bodies.velocity(body);
+                double approach = relative.x * normal.x + relative.y * normal.y;
+                if (approach < 0) relative = relative - normal * (2 * approach);
+                ship->velocity = bodies.velocity(body) + relative;
+                ship->position = bodies.position(body) + normal * (bodies.radius[body] * 1.1);
+                shipBounced = true;
+            }
+        } else {
+            // Ship against ship: fleet ships are destroyed, the player's ship takes their momentum
+            for (uint32_t id : {contact.a, contact.b}) {
+                if (collisions.kindOf(id) == CollisionSystem::Kind::Fleet) {
+                    destroyed.push_back(fleet.handleAt(collisions.indexOf(id)));
+                    gone[id] = 1;
+                }
+            }
+            if (kindA == CollisionSystem::Kind::Ship || kindB == CollisionSystem::Kind::Ship) {
+                uint32_t index = kindA == CollisionSystem::Kind::Fleet ? a : b;
+                double share = fleet.mass[index] / (ship->mass + fleet.mass[index]);
+                ship->velocity = ship->velocity + (Vector2D(fleet.vx[index], fleet.vy[index]) - ship->velocity) * share;
+            }
+        }
+    }
+
+    // Despawning reorders the fleet, so handles were taken first
+    for (const ShipHandle& handle : destroyed) {
+        fleet.despawn(handle);
+    }
+    if (!replacement.empty()) removeBodies(replacement);
+    gravity.invalidate();
+}
+
+void Simulation::removeBodies(const std::vector<int32_t>& replacement) {
+    const size_t n = bodies.size();
+    std::vector<int32_t> newIndex(n, -1);
+    int32_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (replacement[i] == static_cast<int32_t>(i)) newIndex[i] = kept++;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (newIndex[i] < 0 || bodies.parent[i] < 0) continue;
+        // Follow merges to the body that finally holds the parent's mass
+        int32_t p = bodies.parent[i];
+        while (p >= 0 && replacement[p] != p) p = replacement[p];
+        bodies.parent[i] = p >= 0 && p < static_cast<int32_t>(i) ? newIndex[p] : -1;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (newIndex[i] >= 0 && newIndex[i] != static_cast<int32_t>(i)) bodyInfo[newIndex[i]] = std::move(bodyInfo[i]);
+    }
+    bodyInfo.resize(static_cast<size_t>(kept));
+
+    bool remapCurrent = bodyRemapLayout == bodies.layoutVersion;
+    if (remapCurrent) {
+        for (int32_t& to : bodyRemap) {
+            if (to >= 0) to = newIndex[to];
+        }
+    }
+    bodies.compact(newIndex);
+    if (remapCurrent) bodyRemapLayout = bodies.layoutVersion;
+    gravity.invalidate();
+}
+
+void Simulation::resetBodyRemap() {
+    bodyRemap.resize(bodies.size());
+    for (size_t i = 0; i < bodyRemap.size(); i++) bodyRemap[i] = static_cast<int32_t>(i);
+    bodyRemapBase = bodies.layoutVersion;
+    bodyRemapLayout = bodies.layoutVersion;
+}
+
+void Simulation::queueCommand(const SimCommand& command) {
+    // After every command stamped for the same or an earlier tick
+    auto position = std::upper_bound(pendingCommands.begin(), pendingCommands.end(), command,
+                                     [](const SimCommand& a, const SimCommand& b) { return a.tick < b.tick; });
+    pendingCommands.insert(position, command);
+}
+
+void Simulation::applyDueCommands() {
+    size_t due = 0;
+    while (due < pendingCommands.size() && pendingCommands[due].tick <= tick) {
+        // Late commands run now; the log records when they actually ran
+        SimCommand& command = pendingCommands[due++];
+        command.tick = tick;
+        applyCommand(command);
+        if (commandLog && command.changesPhysics()) commandLog->push_back(command);
+    }
+    pendingCommands.erase(pendingCommands.begin(), pendingCommands.begin() + due);
+}
+
+void Simulation::setDeterministic(bool enabled) {
+    deterministic = enabled;
+    // The scalar kernel sums in index order on every CPU; otherwise back to the default
+    gravity.setKernelPath(enabled ? GravityKernel::Path::Scalar : GravityKernel::activePath());
+}
+
+void Simulation::applyCommand(const SimCommand& command) {
+    switch (command.type) {
+        case SimCommand::Type::Thrust:
+            if (command.active) {
+                ship->setThrustDirection(command.direction);
+            }
+            ship->applyThrust(command.active);
+            break;
+        case SimCommand::Type::SetWarp:
+            timeWarpFactor = command.value;
+            break;
+        case SimCommand::Type::ToggleGravityMode:
+            gravity.setMode(gravity.getMode() == GravitySolver::Mode::Exact ?
+                            GravitySolver::Mode::BarnesHut : GravitySolver::Mode::Exact);
+            std::cout << "Gravity: " << (gravity.getMode() == GravitySolver::Mode::Exact ? "exact" : "Barnes-Hut") << "\n";
+            break;
+        case SimCommand::Type::AdjustTheta:
+            gravity.setTheta(gravity.getTheta() + command.value);
+            std::cout << "Barnes-Hut theta: " << gravity.getTheta() << "\n";
+            break;
+        case SimCommand::Type::CycleIntegrator: {
+            static const IntegratorType cycle[] = {IntegratorType::DormandPrince45, IntegratorType::Leapfrog,
+                                                   IntegratorType::Yoshida4, IntegratorType::RK4, IntegratorType::Euler};
+            size_t current = 0;
+            while (cycle[current] != ship->integrator->type()) current++;
+            ship->setIntegrator(cycle[(current + 1) % 5]);
+            shipDrift.reset();
+            std::cout << "Integrator: " << Integrator::name(ship->integrator->type()) << "\n";
+            break;
+        }
+        case SimCommand::Type::TogglePatchedConics:
+            ship->patchedConics = !ship->patchedConics;
+            std::cout << "Patched conics: " << (ship->patchedConics ? "on" : "off") << "\n";
+            break;
+        case SimCommand::Type::SetTrailSpacing:
+            ship->trailMinDistance = command.value;
+            break;
+        case SimCommand::Type::SaveState:
+            if (stateWriter.saveAsync(*this, QUICKSAVE_PATH)) {
+                std::cout << "Saving " << QUICKSAVE_PATH << "\n";
+            }
+            break;
+        case SimCommand::Type::LaunchShip:
+            // Unpowered probe, pushed off the player's ship
+            if (ship) fleet.spawn(100, ship->position, ship->velocity + command.direction.normalized() * command.value, 0, 0);
+            break;
+        case SimCommand::Type::ToggleDiagnostics:
+            diagnosticsEnabled = !diagnosticsEnabled;
+            shipDrift.reset();
+            bodyDrift.reset();
+            break;
+        case SimCommand::Type::SetThreads:
+            // 0 toggles between single-threaded and all cores
+            if (command.value > 0) {
+                setPhysicsThreads(static_cast<unsigned>(command.value));
+            } else {
+                setPhysicsThreads(physicsPool.getThreadCount() > 1 ? 1 : 0);
+            }
+            break;
+    }
+}
+
+void Simulation::setPhysicsThreads(unsigned threadCount) {
+    physicsPool.setThreadCount(threadCount);
+    std::cout << "Physics threads: " << physicsPool.getThreadCount() << "\n";
+}
+
+void Simulation::beginSnapshot(SimSnapshot& snapshot) const {
+    snapshot.previousBodyX = bodies.x;
+    snapshot.previousBodyY = bodies.y;
+    snapshot.previousBodyLayout = bodies.layoutVersion;
+    if (ship) snapshot.ship.previousPosition = ship->position;
+    snapshot.previousFleetX = fleet.x;
+    snapshot.previousFleetY = fleet.y;
+    snapshot.previousFleetLayout = fleet.layoutVersion;
+}
+
+void Simulation::fillSnapshot(SimSnapshot& snapshot) const {
+    snapshot.tick = tick;
+    snapshot.simTime = simTime;
+    snapshot.timeWarpFactor = timeWarpFactor;
+    snapshot.physicsSteps = lastTickSteps;
+    snapshot.diagnosticsEnabled = diagnosticsEnabled;
+    snapshot.shipEnergyDrift = shipDrift.energyDrift();
+    snapshot.shipAngularMomentumDrift = shipDrift.angularMomentumDrift();
+    snapshot.bodyEnergyDrift = bodyDrift.energyDrift();
+    snapshot.bodyAngularMomentumDrift = bodyDrift.angularMomentumDrift();
+    snapshot.bodyX = bodies.x;
+    snapshot.bodyY = bodies.y;
+    if (snapshot.bodyLayout != bodies.layoutVersion || snapshot.bodyRadius.size() != bodies.size()) {
+        snapshot.bodyRadius = bodies.radius;
+        snapshot.bodyLayout = bodies.layoutVersion;
+        if (bodyRemapLayout == bodies.layoutVersion) {
+            snapshot.bodyRemap = bodyRemap;
+            snapshot.bodyRemapBase = bodyRemapBase;
+        } else {
+            snapshot.bodyRemap.clear();
+            snapshot.bodyRemapBase = 0;
+        }
+    }
+    if (ship) ship->fillSnapshot(snapshot.ship);
+    snapshot.fleetX = fleet.x;
+    snapshot.fleetY = fleet.y;
+    snapshot.fleetSize = fleet.renderSize;
+    snapshot.fleetLayout = fleet.layoutVersion;
+}
+
+void Simulation::writeState(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::setprecision(17);
+
+    out << "{\n  \"simTime\": " << simTime << ",\n  \"bodies\": [";
+    for (size_t i = 0; i < bodies.size(); i++) {
+        out << (i ? ",\n" : "\n")
+            << "    {\"mass\": " << bodies.mass[i] << ", \"radius\": " << bodies.radius[i]
+            << ", \"x\": " << bodies.x[i] << ", \"y\": " << bodies.y[i]
+            << ", \"vx\": " << bodies.vx[i] << ", \"vy\": " << bodies.vy[i] << "}";
+    }
+    out << "\n  ]";
+    if (ship) {
+        out << ",\n  \"ship\": {\"x\": " << ship->position.x << ", \"y\": " << ship->position.y
+            << ", \"vx\": " << ship->velocity.x << ", \"vy\": " << ship->velocity.y
+            << ", \"fuel\": " << ship->fuel << "}";
+    }
+    if (fleet.size()) {
+        out << ",\n  \"fleet\": [";
+        for (size_t i = 0; i < fleet.size(); i++) {
+            out << (i ? ",\n" : "\n")
+                << "    {\"x\": " << fleet.x[i] << ", \"y\": " << fleet.y[i]
+                << ", \"vx\": " << fleet.vx[i] << ", \"vy\": " << fleet.vy[i]
+                << ", \"fuel\": " << fleet.fuel[i] << "}";
+        }
+        out << "\n  ]";
+    }
+    out << "\n}\n";
+
+    out.flags(flags);
+    out.precision(precision);
+}
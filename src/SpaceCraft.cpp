@@ -1,82 +1,128 @@
+#include <algorithm>
 #include "../include/SpaceCraft.h"
-#include "../include/CelestialBody.h"
 #include "../include/Constants.h"
+#include "../include/Kepler.h"
 
-Spacecraft::Spacecraft(double mass, Vector2D pos, Vector2D vel, double fuel, double enginePower, int size) 
-    : SpaceObject(mass, pos, vel, size), fuel(fuel), enginePower(enginePower), thrustActive(false) {
+Spacecraft::Spacecraft(double mass, Vector2D pos, Vector2D vel, double fuel, double enginePower) 
+    : position(pos), velocity(vel), mass(mass), fuel(fuel), enginePower(enginePower), thrustActive(false),
+      orbitTrail(TRAIL_CAPACITY), trailMinDistance(TRAIL_PIXEL_SPACING / SCALE_FACTOR),
+      trailMaxInterval(TRAIL_MAX_INTERVAL), trailElapsed(0), trailVersion(0),
+      integrator(Integrator::create(IntegratorType::DormandPrince45)),
+      patchedConics(true), soiThreshold(1e-4), onRails(false) {
     thrustDirection = Vector2D(0, -1); // Default pointing upward
-    orbitTrail = {};
 };
 
-void Spacecraft::update(const std::vector<std::shared_ptr<CelestialBody>>& bodies, double dt, bool RK4){
+void Spacecraft::setIntegrator(IntegratorType type) {
+    integrator = Integrator::create(type);
+}
+
+void Spacecraft::setTrailCapacity(size_t points) {
+    orbitTrail.setCapacity(points);
+    trailVersion++;
+}
+
+void Spacecraft::update(const GravitySolver& gravity, double dt){
+    onRails = false;
+
     // Apply gravitational forces from all celestial bodies
+    // (body positions are held at the start of the step for every stage)
+    AccelerationFunction acceleration = [&](const Vector2D& pos) {
+        return calculateAcceleration(gravity, pos);
+    };
 
-    if(RK4){
-        // RK4 integration for spacecraft
-        Vector2D k1_v = calculateAcceleration(bodies, position);
-        Vector2D k1_p = velocity;
-        
-        Vector2D k2_v = calculateAcceleration(bodies, position + k1_p * (dt/2));
-        Vector2D k2_p = velocity + k1_v * (dt/2);
-        
-        Vector2D k3_v = calculateAcceleration(bodies, position + k2_p * (dt/2));
-        Vector2D k3_p = velocity + k2_v * (dt/2);
-        
-        Vector2D k4_v = calculateAcceleration(bodies, position + k3_p * dt);
-        Vector2D k4_p = velocity + k3_v * dt;
-        
-        // Update position and velocity
-        position = position + (k1_p + k2_p*2 + k3_p*2 + k4_p) * (dt/6);
-        velocity = velocity + (k1_v + k2_v*2 + k3_v*2 + k4_v) * (dt/6);
+    // The engine runs until the step ends or the tank is empty, and the ship
+    // coasts for whatever is left of the step
+    double burnTime = 0;
+    if (thrustActive && fuel > 0) {
+        burnTime = std::min(dt, fuel / (enginePower * FUEL_PER_THRUST));
+        integrator->advance(position, velocity, burnTime, acceleration);
+        fuel -= enginePower * FUEL_PER_THRUST * burnTime;
+        if (fuel <= 0 || burnTime < dt) {
+            fuel = 0;
+            thrustActive = false;
+        }
     }
-    else{
-        Vector2D acceleration = calculateAcceleration(bodies, position);
-        // Update velocity and position using simple Euler integration
-        velocity = velocity + (acceleration * dt);
-        position = position + (velocity * dt);
-    }    
-    
-    // Store position for orbit trail (limited to 1000 points)
-    orbitTrail.push_back(position);
-    if(orbitTrail.size() > 1000){
-        orbitTrail.erase(orbitTrail.begin());
+    if (burnTime < dt) {
+        integrator->advance(position, velocity, dt - burnTime, acceleration);
     }
-    
-    // Check for collisions with celestial bodies
-    for(const auto& body : bodies){
-        Vector2D distanceVector = position - body->position;
-        double distance = distanceVector.magnitude();
-        if (distance < body->radius) {
-            // Simple bounce for now - in a real game you might destroy the spacecraft
-            Vector2D normal = distanceVector.normalized();
-            // not sure on the maths of this 
-            velocity = velocity - (normal * (2 * (velocity.x * normal.x + velocity.y * normal.y)));
-            // Move outside the planet
-            position = body->position + (normal * body->radius * 1.1);
+
+    afterStep(dt);
+};
+
+int Spacecraft::coastingPrimary(const GravitySolver& gravity) const {
+    if (!patchedConics || thrustActive) return -1;
+
+    // Primary = body with the strongest pull
+    const BodyStore& bodies = gravity.bodies();
+    int primary = -1;
+    double strongest = 0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        double dx = bodies.x[i] - position.x;
+        double dy = bodies.y[i] - position.y;
+        double pull = bodies.mass[i] / (dx*dx + dy*dy);
+        if (pull > strongest) {
+            strongest = pull;
+            primary = static_cast<int>(i);
         }
     }
-};
+    if (primary < 0) return -1;
 
-Vector2D Spacecraft::calculateAcceleration(const std::vector<std::shared_ptr<CelestialBody>>& bodies, const Vector2D& pos) {
-    Vector2D acceleration(0, 0);
-    
-    // Apply gravitational forces
-    for (const auto& body : bodies) {
-        Vector2D direction = body->position - pos;
-        double distance = direction.magnitude();
-        
-        if (distance < body->radius) continue; // Inside body
-        
-        double forceMagnitude = GRAVITATIONAL_CONSTANT * body->mass / (distance * distance);
-        acceleration = acceleration + direction.normalized() * forceMagnitude;
+    // Tidal perturbation from everything else: their pull on the ship minus their
+    // pull on the primary (which moves the whole frame)
+    Vector2D toPrimary = bodies.position(primary) - position;
+    double dist = toPrimary.magnitude();
+    if (dist < bodies.radius[primary]) return -1;
+    Vector2D primaryPull = toPrimary * (GRAVITATIONAL_CONSTANT * bodies.mass[primary] / (dist * dist * dist));
+    Vector2D others = gravity.accelerationAt(position) - primaryPull;
+    Vector2D perturbation = others - Vector2D(gravity.ax[primary], gravity.ay[primary]);
+
+    return perturbation.magnitude() < soiThreshold * primaryPull.magnitude() ? primary : -1;
+}
+
+void Spacecraft::coast(const GravitySolver& gravity, size_t primary, Vector2D relativePosition, Vector2D relativeVelocity, double dt) {
+    const BodyStore& bodies = gravity.bodies();
+    double mu = GRAVITATIONAL_CONSTANT * (bodies.mass[primary] + mass);
+
+    if (!Kepler::propagate(relativePosition, relativeVelocity, mu, dt)) {
+        // Solver failed: fall back to numerical integration from the start state
+        position = bodies.position(primary) + relativePosition;
+        velocity = bodies.velocity(primary) + relativeVelocity;
+        update(gravity, dt);
+        return;
     }
+
+    // Re-anchor the conic on wherever the primary moved to
+    position = bodies.position(primary) + relativePosition;
+    velocity = bodies.velocity(primary) + relativeVelocity;
+    onRails = true;
+
+    afterStep(dt);
+}
+
+void Spacecraft::afterStep(double dt) {
+    // Collisions are resolved by the simulation once everything has moved
+    recordTrail(dt);
+}
+
+void Spacecraft::recordTrail(double dt) {
+    trailElapsed += dt;
+    if (!orbitTrail.empty() && trailElapsed < trailMaxInterval &&
+        (position - orbitTrail.back()).magnitude() < trailMinDistance) {
+        return;
+    }
+    orbitTrail.push(position);
+    trailElapsed = 0;
+    trailVersion++;
+}
+
+Vector2D Spacecraft::calculateAcceleration(const GravitySolver& gravity, const Vector2D& pos) const {
+    // Apply gravitational forces (Barnes-Hut tree or exact sum)
+    Vector2D acceleration = gravity.accelerationAt(pos);
     
-    // Apply thrust
+    // Apply thrust (fuel is burned once per update, not per stage evaluation)
     if (thrustActive && fuel > 0) {
         double thrustAcceleration = enginePower / mass;
         acceleration = acceleration + (thrustDirection * thrustAcceleration);
-        fuel -= enginePower * 0.01; // *dt Consume fuel
-        if (fuel < 0) fuel = 0;
     }
     
     return acceleration;
@@ -90,35 +136,15 @@ void Spacecraft::setThrustDirection(const Vector2D& direction) {
     thrustDirection = direction.normalized();
 };
 
-void Spacecraft::renderTrail(SDL_Renderer* renderer, Vector2D cameraOffset, double scale) {
-    if (orbitTrail.size() < 2) return;
-    
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 128);
-    for (size_t i = 1; i < orbitTrail.size(); i++) {
-        SDL_RenderDrawLine(
-            renderer,
-            static_cast<int>((orbitTrail[i-1].x * scale) + (SCREEN_WIDTH / 2) + cameraOffset.x),
-            static_cast<int>((orbitTrail[i-1].y * scale) + (SCREEN_HEIGHT / 2) + cameraOffset.y),
-            static_cast<int>((orbitTrail[i].x * scale) + (SCREEN_WIDTH / 2) + cameraOffset.x),
-            static_cast<int>((orbitTrail[i].y * scale) + (SCREEN_HEIGHT / 2) + cameraOffset.y)
-        );
+void Spacecraft::fillSnapshot(ShipSnapshot& state) const {
+    state.position = position;
+    state.velocity = velocity;
+    state.thrustDirection = thrustDirection;
+    state.thrusting = thrustActive && fuel > 0;
+    state.fuel = fuel;
+    state.onRails = onRails;
+    if (state.trailVersion != trailVersion) {
+        orbitTrail.copyTo(state.trail);
+        state.trailVersion = trailVersion;
     }
-};
-
-void Spacecraft::render(SDL_Renderer* renderer, Vector2D cameraOffset, double scale){
-    // Render the trail first so spacecraft appears on top
-    renderTrail(renderer, cameraOffset, scale);
-    
-    // Then render the spacecraft itself
-    SpaceObject::render(renderer, cameraOffset, scale);
-    
-    // Render thrust if active
-    if (thrustActive && fuel > 0) {
-        SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255); // Orange for thrust
-        int shipX = static_cast<int>((position.x * scale) + (SCREEN_WIDTH / 2) + cameraOffset.x);
-        int shipY = static_cast<int>((position.y * scale) + (SCREEN_HEIGHT / 2) + cameraOffset.y);
-        int thrustEndX = shipX - static_cast<int>(thrustDirection.x * size);
-        int thrustEndY = shipY - static_cast<int>(thrustDirection.y * size);
-        SDL_RenderDrawLine(renderer, shipX, shipY, thrustEndX, thrustEndY);
-    }
-};
\ No newline at end of file
+}
@@ -1,37 +1,28 @@
-#include <SDL2/SDL_image.h>
 #include <iostream>
 #include "../include/SpaceObject.h"
 #include "../include/Utils.h"
 #include "../include/Constants.h"
 
-SpaceObject::SpaceObject(double mass, Vector2D pos, Vector2D vel, int size): 
-    mass(mass), position(pos), velocity(vel), size(size), texture(nullptr){};
+SpaceObject::SpaceObject(int size): 
+    size(size){};
 
-SpaceObject::~SpaceObject(){
-    if(texture){
-        SDL_DestroyTexture(texture);
-    }
-};
+SpaceObject::~SpaceObject(){};
 
 
-void SpaceObject::render(SDL_Renderer* renderer, Vector2D cameraOffset, double scale) {
-    if (!texture) return;
-    
-    SDL_Rect destRect;
-    destRect.x = static_cast<int>((position.x * scale) + (SCREEN_WIDTH / 2) - (size / 2) + cameraOffset.x);
-    destRect.y = static_cast<int>((position.y * scale) + (SCREEN_HEIGHT / 2) - (size / 2) + cameraOffset.y);
-    destRect.w = size;
-    destRect.h = size;
+void SpaceObject::render(SpriteBatch& sprites, Vector2D worldPos, Vector2D cameraOffset, double scale) {
+    if (!sprite) return;
     
-    SDL_RenderCopy(renderer, texture, NULL, &destRect);
+    // Top-left corner on screen; nothing to draw outside the viewport
+    double left = (worldPos.x * scale) + (SCREEN_WIDTH / 2) - (size / 2) + cameraOffset.x;
+    double top = (worldPos.y * scale) + (SCREEN_HEIGHT / 2) - (size / 2) + cameraOffset.y;
+    if (left + size < 0 || left > SCREEN_WIDTH || top + size < 0 || top > SCREEN_HEIGHT) {
+        return;
+    }
+
+    sprites.add(sprite, static_cast<float>(left + size / 2.0), static_cast<float>(top + size / 2.0), static_cast<float>(size));
 };
 
-void SpaceObject::loadTexture(SDL_Renderer* renderer, const char* path) {
-    SDL_Surface* surface = IMG_Load(path);
-    if (surface) {
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_FreeSurface(surface);
-    } else {
-        std::cerr << "Failed to load image: " << path << std::endl;
-    }
+void SpaceObject::loadSprite(ResourceManager& resources, const char* path) {
+    // Decoded and uploaded once, however many objects share it
+    sprite = resources.sprite(path);
 };
@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cmath>
+#include "../include/SpacecraftView.h"
+#include "../include/Constants.h"
+
+SpacecraftView::SpacecraftView(const Spacecraft& ship, int size) : SpaceObject(size), ship(&ship) {}
+
+void SpacecraftView::renderTrail(LineBatch& batch, const std::vector<Vector2D>& trail, Vector2D head, Vector2D cameraOffset, double scale) {
+    if (trail.empty()) return;
+
+    SDL_Color color = {255, 255, 255, 160};
+    batch.addPolyline(trail.data(), trail.size(), cameraOffset, scale, color, 0, 1.5f);
+
+    // Points are decimated, so close the gap to where the ship is now
+    Vector2D tail[] = {trail.back(), head};
+    batch.addPolyline(tail, 2, cameraOffset, scale, color, color.a, 1.5f);
+};
+
+void SpacecraftView::renderPrediction(LineBatch& batch, const Trajectory& path, double now, Vector2D head, Vector2D cameraOffset, double scale) {
+    if (path.points.empty() || path.step <= 0) return;
+
+    // Skip what the ship has already flown; the published path can lag a tick behind
+    size_t first = static_cast<size_t>(std::max(std::ceil((now - path.startTime) / path.step), 0.0));
+    if (first >= path.points.size()) return;
+
+    SDL_Color color = {90, 200, 255, 40};
+    Uint8 nearAlpha = 160;
+    Vector2D lead[] = {head, path.points[first]};
+    batch.addPolyline(lead, 2, cameraOffset, scale, color, nearAlpha, 1.5f);
+    batch.addPolyline(path.points.data() + first, path.points.size() - first, cameraOffset, scale, color, nearAlpha, 1.5f);
+
+    // Diamonds: closest approaches in yellow, sphere of influence crossings in violet
+    for (const TrajectoryEvent& event : path.events) {
+        if (event.time < now) continue;
+        SDL_Color marker = event.type == TrajectoryEvent::Type::ClosestApproach ? SDL_Color{255, 220, 90, 220}
+                                                                                : SDL_Color{200, 120, 255, 220};
+        float x = static_cast<float>(event.position.x * scale + SCREEN_WIDTH / 2 + cameraOffset.x);
+        float y = static_cast<float>(event.position.y * scale + SCREEN_HEIGHT / 2 + cameraOffset.y);
+        SDL_FPoint diamond[] = {{x, y - 5}, {x + 5, y}, {x, y + 5}, {x - 5, y}, {x, y - 5}};
+        batch.addScreenPolyline(diamond, 5, marker, marker.a, 1.5f);
+    }
+}
+
+void SpacecraftView::renderThrust(SDL_Renderer* renderer, const ShipSnapshot& state, Vector2D worldPos, Vector2D cameraOffset, double scale){
+    // Render thrust if active
+    if (state.thrusting) {
+        SDL_SetRenderDrawColor(renderer, 255, 165, 0, 255); // Orange for thrust
+        int shipX = static_cast<int>((worldPos.x * scale) + (SCREEN_WIDTH / 2) + cameraOffset.x);
+        int shipY = static_cast<int>((worldPos.y * scale) + (SCREEN_HEIGHT / 2) + cameraOffset.y);
+        int thrustEndX = shipX - static_cast<int>(state.thrustDirection.x * size);
+        int thrustEndY = shipY - static_cast<int>(state.thrustDirection.y * size);
+        SDL_RenderDrawLine(renderer, shipX, shipY, thrustEndX, thrustEndY);
+    }
+};
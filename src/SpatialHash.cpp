@@ -0,0 +1,185 @@
+#include <cmath>
+#include <limits>
+#include "../include/SpatialHash.h"
+
+namespace {
+
+const double MAX_CELL_COORDINATE = 1e15; // Keeps runaway or non-finite positions castable
+
+}
+
+const int SpatialHash::LEVELS;
+const int SpatialHash::DEPTHS;
+const uint32_t SpatialHash::NONE;
+
+int64_t SpatialHash::cellCoordinate(double value, double cellSize) {
+    double cell = std::floor(value / cellSize);
+    if (!(cell > -MAX_CELL_COORDINATE)) cell = -MAX_CELL_COORDINATE; // Also catches NaN
+    if (cell > MAX_CELL_COORDINATE) cell = MAX_CELL_COORDINATE;
+    return static_cast<int64_t>(cell);
+}
+
+void SpatialHash::setCellSize(double size) {
+    levelSize[0] = size > 0 ? size : 1;
+    for (int level = 1; level < LEVELS; level++) {
+        levelSize[level] = levelSize[level - 1] * 4;
+    }
+    clear();
+}
+
+void SpatialHash::clear() {
+    boxes.clear();
+    std::fill(buckets.begin(), buckets.end(), NONE);
+    entries.clear();
+    freeEntry = NONE;
+    entryCount = 0;
+    std::fill(&occupied[0][0], &occupied[0][0] + LEVELS * DEPTHS, 0);
+    huge.clear();
+}
+
+size_t SpatialHash::bucketOf(int32_t level, int32_t depth, uint32_t slice, int64_t cellX, int64_t cellY) const {
+    uint64_t h = static_cast<uint64_t>(cellX) * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(cellY) * 0xC2B2AE3D27D4EB4Full ^
+                 static_cast<uint64_t>(level * DEPTHS + depth) * 0x165667B19E3779F9ull ^
+                 static_cast<uint64_t>(slice) * 0xD6E8FEB86659FD93ull;
+    return static_cast<size_t>(h ^ (h >> 29)) & bucketMask;
+}
+
+void SpatialHash::update(uint32_t id, double minX, double minY, double maxX, double maxY, uint8_t depth, uint32_t slice) {
+    if (id >= boxes.size()) boxes.resize(id + 1, Box{0, 0, 0, 0, 0, 0, -1, -1, 0, 0, 0, false, {NONE, NONE, NONE, NONE}});
+
+    // Finest level where the box is no wider than a cell, so it spans at most 2x2
+    Box box;
+    box.minX = minX;
+    box.minY = minY;
+    box.maxX = maxX;
+    box.maxY = maxY;
+    box.slice = depth < DEPTHS ? slice : slice >> (depth - (DEPTHS - 1));
+    box.depth = depth < DEPTHS ? depth : DEPTHS - 1;
+    double extent = std::max(maxX - minX, maxY - minY);
+    box.level = 0;
+    while (box.level < LEVELS && !(extent <= levelSize[box.level])) box.level++;
+    if (box.level < LEVELS) {
+        double size = levelSize[box.level];
+        box.cellX0 = cellCoordinate(minX, size);
+        box.cellY0 = cellCoordinate(minY, size);
+        box.cellX1 = cellCoordinate(maxX, size);
+        box.cellY1 = cellCoordinate(maxY, size);
+    } else {
+        box.cellX0 = box.cellY0 = box.cellX1 = box.cellY1 = 0;
+    }
+    box.present = true;
+
+    Box& old = boxes[id];
+    if (old.present && old.level == box.level && old.depth == box.depth && old.slice == box.slice &&
+        old.cellX0 == box.cellX0 && old.cellY0 == box.cellY0 && old.cellX1 == box.cellX1 && old.cellY1 == box.cellY1) {
+        // Same cells: only the exact bounds change
+        old.minX = minX;
+        old.minY = minY;
+        old.maxX = maxX;
+        old.maxY = maxY;
+        return;
+    }
+
+    remove(id);
+    old = box;
+    if (old.level >= LEVELS) {
+        huge.push_back(id);
+    } else {
+        insertCells(id, old);
+    }
+}
+
+void SpatialHash::remove(uint32_t id) {
+    if (id >= boxes.size() || !boxes[id].present) return;
+    Box& box = boxes[id];
+    if (box.level >= LEVELS) {
+        huge.erase(std::find(huge.begin(), huge.end(), id));
+    } else {
+        removeCells(box);
+    }
+    box.present = false;
+}
+
+void SpatialHash::preparePairs() {
+    const double inf = std::numeric_limits<double>::infinity();
+    Bounds extent[LEVELS][DEPTHS];
+    for (int level = 0; level < LEVELS; level++) {
+        for (int depth = 0; depth < DEPTHS; depth++) extent[level][depth] = Bounds{inf, inf, -inf, -inf};
+    }
+    for (const Box& box : boxes) {
+        if (!box.present || box.level >= LEVELS) continue;
+        Bounds& around = extent[box.level][box.depth];
+        around.minX = std::min(around.minX, box.minX);
+        around.minY = std::min(around.minY, box.minY);
+        around.maxX = std::max(around.maxX, box.maxX);
+        around.maxY = std::max(around.maxY, box.maxY);
+    }
+
+    layers.clear();
+    for (int32_t level = 0; level < LEVELS; level++) {
+        for (int32_t depth = 0; depth < DEPTHS; depth++) {
+            if (occupied[level][depth]) layers.push_back(Layer{level, depth, extent[level][depth]});
+        }
+    }
+}
+
+void SpatialHash::insertCells(uint32_t id, Box& box) {
+    size_t cells = static_cast<size_t>((box.cellX1 - box.cellX0 + 1) * (box.cellY1 - box.cellY0 + 1));
+    // Keep about two buckets per entry, so most lookups of empty cells stop at the head
+    if ((entryCount + cells) * 2 > buckets.size()) rehash(std::max<size_t>(1024, (entryCount + cells) * 4));
+    int k = 0;
+    for (int64_t cy = box.cellY0; cy <= box.cellY1; cy++) {
+        for (int64_t cx = box.cellX0; cx <= box.cellX1; cx++) {
+            uint32_t e = freeEntry;
+            if (e != NONE) {
+                freeEntry = entries[e].next;
+            } else {
+                e = static_cast<uint32_t>(entries.size());
+                entries.emplace_back();
+            }
+            uint32_t& head = buckets[bucketOf(box.level, box.depth, box.slice, cx, cy)];
+            entries[e] = Entry{id, box.slice, box.level, box.depth, cx, cy, head, NONE};
+            if (head != NONE) entries[head].prev = e;
+            head = e;
+            box.entry[k++] = e;
+        }
+    }
+    entryCount += cells;
+    occupied[box.level][box.depth]++;
+}
+
+void SpatialHash::removeCells(Box& box) {
+    size_t cells = static_cast<size_t>((box.cellX1 - box.cellX0 + 1) * (box.cellY1 - box.cellY0 + 1));
+    for (size_t k = 0; k < cells; k++) {
+        uint32_t e = box.entry[k];
+        Entry& entry = entries[e];
+        if (entry.prev != NONE) {
+            entries[entry.prev].next = entry.next;
+        } else {
+            buckets[bucketOf(entry.level, entry.depth, entry.slice, entry.cellX, entry.cellY)] = entry.next;
+        }
+        if (entry.next != NONE) entries[entry.next].prev = entry.prev;
+        entry.id = NONE;
+        entry.next = freeEntry;
+        freeEntry = e;
+    }
+    entryCount -= cells;
+    occupied[box.level][box.depth]--;
+}
+
+void SpatialHash::rehash(size_t bucketCount) {
+    size_t size = 1;
+    while (size < bucketCount) size <<= 1;
+
+    buckets.assign(size, NONE);
+    bucketMask = size - 1;
+    for (uint32_t e = 0; e < entries.size(); e++) {
+        Entry& entry = entries[e];
+        if (entry.id == NONE) continue;
+        uint32_t& head = buckets[bucketOf(entry.level, entry.depth, entry.slice, entry.cellX, entry.cellY)];
+        entry.next = head;
+        entry.prev = NONE;
+        if (head != NONE) entries[head].prev = e;
+        head = e;
+    }
+}
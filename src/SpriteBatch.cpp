@@ -0,0 +1,57 @@
+#include <iostream>
+#include "../include/SpriteBatch.h"
+
+SpriteBatch::SpriteBatch() : geometrySupported(true) {}
+
+void SpriteBatch::begin() {
+    quads.clear();
+}
+
+void SpriteBatch::add(const SpriteHandle& sprite, float centerX, float centerY, float size) {
+    if (!sprite) return;
+    quads.push_back(Quad{sprite.get(), SDL_FRect{centerX - size / 2, centerY - size / 2, size, size}});
+}
+
+void SpriteBatch::flush(SDL_Renderer* renderer, ResourceManager& resources) {
+    if (quads.empty()) return;
+
+    // Atlas first: a repack moves the regions
+    SDL_Texture* atlas = resources.atlas();
+    if (!atlas) return;
+
+    if (geometrySupported) {
+        float invW = 1.0f / resources.atlasWidth();
+        float invH = 1.0f / resources.atlasHeight();
+        SDL_Color white = {255, 255, 255, 255};
+
+        vertices.clear();
+        indices.clear();
+        for (const Quad& quad : quads) {
+            const SDL_Rect& r = quad.sprite->region;
+            float u0 = r.x * invW, v0 = r.y * invH;
+            float u1 = (r.x + r.w) * invW, v1 = (r.y + r.h) * invH;
+            float x0 = quad.dest.x, y0 = quad.dest.y;
+            float x1 = x0 + quad.dest.w, y1 = y0 + quad.dest.h;
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y0}, white, SDL_FPoint{u0, v0}});
+            vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y0}, white, SDL_FPoint{u1, v0}});
+            vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y1}, white, SDL_FPoint{u0, v1}});
+            vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y1}, white, SDL_FPoint{u1, v1}});
+
+            int quadIndices[] = {base, base + 1, base + 2, base + 1, base + 3, base + 2};
+            indices.insert(indices.end(), quadIndices, quadIndices + 6);
+        }
+
+        if (SDL_RenderGeometry(renderer, atlas, vertices.data(), static_cast<int>(vertices.size()),
+                               indices.data(), static_cast<int>(indices.size())) == 0) {
+            return;
+        }
+        std::cerr << "SDL_RenderGeometry failed, drawing sprites one by one: " << SDL_GetError() << std::endl;
+        geometrySupported = false;
+    }
+
+    for (const Quad& quad : quads) {
+        SDL_RenderCopyF(renderer, atlas, &quad.sprite->region, &quad.dest);
+    }
+}
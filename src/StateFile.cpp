@@ -0,0 +1,639 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "../include/StateFile.h"
+#include "../include/Simulation.h"
+#include "../include/ShipStore.h"
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'S', 'S', 'I', 'M', 'S', 'T', 'A', 'T'};
+const uint32_t ENDIAN_TAG = 0x01020304; // Reads back differently on a foreign byte order
+const size_t ALIGNMENT = 64;
+const int BODY_ARRAYS = 7; // x, y, vx, vy, mass, radius, parent
+
+// Fixed-size little-endian layout; every field is naturally aligned
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianTag;
+    uint64_t fileSize;
+    uint64_t bodyCount;
+    uint64_t tick;
+    double simTime;
+    double timeWarpFactor;
+    double theta;
+    int32_t gravityMode;
+    uint32_t diagnosticsEnabled;
+    uint64_t arrayOffset[BODY_ARRAYS];
+    uint64_t infoOffset; // Render info, only for bodies that have a sprite
+    uint64_t infoCount;
+    uint64_t shipOffset; // 0 when there is no ship
+    uint64_t fleetOffset; // Fleet arrays, laid out by fleetLayout
+    uint64_t fleetCount;
+    uint64_t fleetSlotCount;
+    uint32_t fleetFreeHead;
+    uint32_t collisionsEnabled;
+    double fleetTrailInterval;
+};
+
+// Version 1 headers stop at shipOffset
+const size_t V1_HEADER_SIZE = offsetof(Header, fleetOffset);
+
+// Followed by spriteLength bytes, padded to 8
+struct InfoRecord {
+    uint64_t index;
+    int32_t renderSize;
+    uint32_t spriteLength;
+};
+
+// Followed by trailCount (x, y) pairs, oldest first
+struct ShipRecord {
+    double x, y, vx, vy;
+    double mass, fuel, enginePower;
+    double thrustX, thrustY;
+    double trailMinDistance, trailMaxInterval, trailElapsed;
+    double soiThreshold;
+    double integratorStep; // Adaptive step size or fixed max step, so a resumed run matches
+    uint64_t trailVersion, trailCapacity, trailCount;
+    int32_t integrator;
+    uint8_t thrustActive, patchedConics, onRails, padding;
+};
+
+size_t alignUp(size_t n, size_t alignment) {
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+// Calls visit(array, entriesPerShip) for every fleet component in file order
+template <typename Store, typename Visit>
+void visitFleetArrays(Store& fleet, Visit visit) {
+    visit(fleet.x, 1);
+    visit(fleet.y, 1);
+    visit(fleet.vx, 1);
+    visit(fleet.vy, 1);
+    visit(fleet.ax, 1);
+    visit(fleet.ay, 1);
+    visit(fleet.mass, 1);
+    visit(fleet.fuel, 1);
+    visit(fleet.thrust, 1);
+    visit(fleet.thrustX, 1);
+    visit(fleet.thrustY, 1);
+    visit(fleet.trailElapsed, 1);
+    visit(fleet.trailPoints, ShipStore::TRAIL_POINTS * 2);
+    visit(fleet.owner, 1);
+    visit(fleet.trailHead, 1);
+    visit(fleet.trailCount, 1);
+    visit(fleet.burning, 1);
+    visit(fleet.renderSize, 1);
+}
+
+// Offsets of the fleet arrays from fleetOffset, each 64-byte aligned, then the
+// slot table; returns the total size
+template <typename Store>
+uint64_t fleetLayout(Store& fleet, uint64_t count, uint64_t slotCount, std::vector<uint64_t>& offsets) {
+    offsets.clear();
+    uint64_t offset = 0;
+    visitFleetArrays(fleet, [&](auto& array, size_t perShip) {
+        offsets.push_back(offset);
+        offset = alignUp(offset + count * perShip * sizeof(array[0]), ALIGNMENT);
+    });
+    offsets.push_back(offset);
+    return offset + slotCount * sizeof(ShipStore::Slot);
+}
+
+// Read-only view of a whole file; mapped where the platform allows
+class MappedFile {
+public:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (fallback.empty()) return;
+        data = fallback.data();
+        size = fallback.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                // Arrays are read front to back once
+                madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                data = static_cast<const char*>(mapped);
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(fd); // The mapping stays valid
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data) munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+#ifdef _WIN32
+    std::vector<char> fallback;
+#endif
+};
+
+// Bounds-checked [offset, offset + bytes) inside a file of size fileSize
+bool inside(uint64_t offset, uint64_t bytes, uint64_t fileSize) {
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// Physical values follow the scenario files' rules: finite, and masses and
+// radii positive, so a corrupt file can't reach the physics
+bool finiteValue(double value) {
+    return std::isfinite(value);
+}
+
+bool positive(double value) {
+    return std::isfinite(value) && value > 0;
+}
+
+bool nonNegative(double value) {
+    return std::isfinite(value) && value >= 0;
+}
+
+// Every one of count doubles starting at values passes check
+template <typename Check>
+bool everyValue(const char* values, uint64_t count, Check check) {
+    for (uint64_t i = 0; i < count; i++) {
+        double value;
+        std::memcpy(&value, values + i * sizeof(value), sizeof(value));
+        if (!check(value)) return false;
+    }
+    return true;
+}
+
+// Copy the fleet out of a state file, checking that handles, the free list and
+// trail rings are consistent so a bad file can't cause out-of-range access later,
+// and that every ship's state is physical
+bool decodeFleet(const Header& header, const char* data, size_t size, ShipStore& fleet) {
+    const uint64_t n = header.fleetCount;
+    const uint64_t slotCount = header.fleetSlotCount;
+    if (n > size / 8 || slotCount > size / 8 || n > slotCount || slotCount > UINT32_MAX) return false;
+    std::vector<uint64_t> offsets;
+    uint64_t bytes = fleetLayout(fleet, n, slotCount, offsets);
+    if (header.fleetOffset % ALIGNMENT != 0 || !inside(header.fleetOffset, bytes, size)) return false;
+
+    const char* base = data + header.fleetOffset;
+    size_t array = 0;
+    visitFleetArrays(fleet, [&](auto& values, size_t perShip) {
+        values.resize(static_cast<size_t>(n * perShip));
+        if (n) std::memcpy(values.data(), base + offsets[array], values.size() * sizeof(values[0]));
+        array++;
+    });
+    fleet.slots.resize(static_cast<size_t>(slotCount));
+    if (slotCount) std::memcpy(fleet.slots.data(), base + offsets[array], fleet.slots.size() * sizeof(ShipStore::Slot));
+    fleet.freeHead = header.fleetFreeHead;
+    fleet.trailInterval = header.fleetTrailInterval;
+
+    // Every ship owns a distinct slot that points back at it
+    std::vector<uint8_t> live(static_cast<size_t>(slotCount), 0);
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t slot = fleet.owner[i];
+        if (slot >= slotCount || live[slot] || fleet.slots[slot].index != i) return false;
+        live[slot] = 1;
+        if (fleet.trailHead[i] >= ShipStore::TRAIL_POINTS || fleet.trailCount[i] > ShipStore::TRAIL_POINTS) return false;
+        if (!finiteValue(fleet.x[i]) || !finiteValue(fleet.y[i]) || !finiteValue(fleet.vx[i]) ||
+            !finiteValue(fleet.vy[i]) || !positive(fleet.mass[i]) || !nonNegative(fleet.fuel[i]) ||
+            !nonNegative(fleet.thrust[i]) || !finiteValue(fleet.thrustX[i]) || !finiteValue(fleet.thrustY[i])) {
+            return false;
+        }
+    }
+    // The free list covers exactly the remaining slots
+    uint64_t freeSlots = 0;
+    for (uint32_t slot = fleet.freeHead; slot != UINT32_MAX; slot = fleet.slots[slot].index) {
+        if (slot >= slotCount || live[slot] || ++freeSlots > slotCount - n) return false;
+        live[slot] = 1;
+    }
+    return freeSlots == slotCount - n;
+}
+
+}
+
+const uint32_t StateFile::VERSION;
+
+void StateFile::encode(const Simulation& simulation, std::vector<char>& out) {
+    const BodyStore& bodies = simulation.bodies;
+    const uint64_t n = bodies.size();
+    const Spacecraft* ship = simulation.ship.get();
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.endianTag = ENDIAN_TAG;
+    header.bodyCount = n;
+    header.tick = simulation.tick;
+    header.simTime = simulation.simTime;
+    header.timeWarpFactor = simulation.timeWarpFactor;
+    header.theta = simulation.gravity.getTheta();
+    header.gravityMode = static_cast<int32_t>(simulation.gravity.getMode());
+    header.diagnosticsEnabled = simulation.diagnosticsEnabled ? 1 : 0;
+    header.collisionsEnabled = simulation.collisionsEnabled ? 1 : 0;
+
+    // Layout: header, aligned body arrays, render info, ship
+    const void* arrays[BODY_ARRAYS] = {bodies.x.data(), bodies.y.data(), bodies.vx.data(), bodies.vy.data(),
+                                       bodies.mass.data(), bodies.radius.data(), bodies.parent.data()};
+    const size_t arrayBytes[BODY_ARRAYS] = {n * 8, n * 8, n * 8, n * 8, n * 8, n * 8, n * sizeof(int32_t)};
+    size_t offset = alignUp(sizeof(Header), ALIGNMENT);
+    for (int a = 0; a < BODY_ARRAYS; a++) {
+        header.arrayOffset[a] = offset;
+        offset = alignUp(offset + arrayBytes[a], ALIGNMENT);
+    }
+
+    header.infoOffset = offset;
+    for (size_t i = 0; i < simulation.bodyInfo.size() && i < n; i++) {
+        const BodyInfo& info = simulation.bodyInfo[i];
+        if (info.sprite.empty() && info.renderSize == 0) continue;
+        header.infoCount++;
+        offset += sizeof(InfoRecord) + alignUp(info.sprite.size(), 8);
+    }
+
+    if (ship) {
+        offset = alignUp(offset, ALIGNMENT);
+        header.shipOffset = offset;
+        offset += sizeof(ShipRecord) + ship->orbitTrail.size() * 2 * sizeof(double);
+    }
+
+    const ShipStore& fleet = simulation.fleet;
+    std::vector<uint64_t> fleetOffsets;
+    offset = alignUp(offset, ALIGNMENT);
+    header.fleetOffset = offset;
+    header.fleetCount = fleet.size();
+    header.fleetSlotCount = fleet.slots.size();
+    header.fleetFreeHead = fleet.freeHead;
+    header.fleetTrailInterval = fleet.trailInterval;
+    offset += fleetLayout(fleet, header.fleetCount, header.fleetSlotCount, fleetOffsets);
+    header.fileSize = offset;
+
+    // Zeroed so padding is deterministic and identical states give identical files
+    out.assign(offset, 0);
+    char* base = out.data();
+    std::memcpy(base, &header, sizeof(header));
+    for (int a = 0; a < BODY_ARRAYS; a++) {
+        if (arrayBytes[a]) std::memcpy(base + header.arrayOffset[a], arrays[a], arrayBytes[a]);
+    }
+
+    char* cursor = base + header.infoOffset;
+    for (size_t i = 0; i < simulation.bodyInfo.size() && i < n; i++) {
+        const BodyInfo& info = simulation.bodyInfo[i];
+        if (info.sprite.empty() && info.renderSize == 0) continue;
+        InfoRecord record = {i, info.renderSize, static_cast<uint32_t>(info.sprite.size())};
+        std::memcpy(cursor, &record, sizeof(record));
+        std::memcpy(cursor + sizeof(record), info.sprite.data(), info.sprite.size());
+        cursor += sizeof(record) + alignUp(info.sprite.size(), 8);
+    }
+
+    if (ship) {
+        ShipRecord record = {};
+        record.x = ship->position.x;
+        record.y = ship->position.y;
+        record.vx = ship->velocity.x;
+        record.vy = ship->velocity.y;
+        record.mass = ship->mass;
+        record.fuel = ship->fuel;
+        record.enginePower = ship->enginePower;
+        record.thrustX = ship->thrustDirection.x;
+        record.thrustY = ship->thrustDirection.y;
+        record.trailMinDistance = ship->trailMinDistance;
+        record.trailMaxInterval = ship->trailMaxInterval;
+        record.trailElapsed = ship->trailElapsed;
+        record.soiThreshold = ship->soiThreshold;
+        record.trailVersion = ship->trailVersion;
+        record.trailCapacity = ship->orbitTrail.capacity();
+        record.trailCount = ship->orbitTrail.size();
+        record.integrator = static_cast<int32_t>(ship->integrator->type());
+        if (auto* adaptive = dynamic_cast<const DormandPrinceIntegrator*>(ship->integrator.get())) {
+            record.integratorStep = adaptive->currentStep;
+        } else if (auto* fixed = dynamic_cast<const FixedStepIntegrator*>(ship->integrator.get())) {
+            record.integratorStep = fixed->maxStep;
+        }
+        record.thrustActive = ship->thrustActive;
+        record.patchedConics = ship->patchedConics;
+        record.onRails = ship->onRails;
+
+        cursor = base + header.shipOffset;
+        std::memcpy(cursor, &record, sizeof(record));
+        cursor += sizeof(record);
+        for (size_t i = 0; i < ship->orbitTrail.size(); i++) {
+            const Vector2D& point = ship->orbitTrail[i];
+            double xy[2] = {point.x, point.y};
+            std::memcpy(cursor, xy, sizeof(xy));
+            cursor += sizeof(xy);
+        }
+    }
+
+    size_t array = 0;
+    visitFleetArrays(fleet, [&](const auto& values, size_t) {
+        if (!values.empty()) {
+            std::memcpy(base + header.fleetOffset + fleetOffsets[array], values.data(), values.size() * sizeof(values[0]));
+        }
+        array++;
+    });
+    if (!fleet.slots.empty()) {
+        std::memcpy(base + header.fleetOffset + fleetOffsets[array], fleet.slots.data(),
+                    fleet.slots.size() * sizeof(ShipStore::Slot));
+    }
+}
+
+bool StateFile::writeBytes(const std::vector<char>& bytes, const std::string& path) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to open " << temporary << std::endl;
+            return false;
+        }
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out.flush()) {
+            std::cerr << "Failed to write " << temporary << std::endl;
+            return false;
+        }
+    }
+    std::remove(path.c_str()); // rename won't replace an existing file on every platform
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to move " << temporary << " to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool StateFile::save(const Simulation& simulation, const std::string& path) {
+    std::vector<char> bytes;
+    encode(simulation, bytes);
+    return writeBytes(bytes, path);
+}
+
+bool StateFile::load(Simulation& simulation, const std::string& path) {
+    MappedFile file(path);
+    if (!file.data) {
+        std::cerr << "Failed to read " << path << std::endl;
+        return false;
+    }
+    return decode(simulation, file.data, file.size, path);
+}
+
+bool StateFile::decode(Simulation& simulation, const char* data, size_t size, const std::string& sourceName) {
+    // Validate everything before touching the simulation. Version 1 headers end
+    // before the fleet fields; the rest of the layout is found through offsets.
+    Header header = {};
+    if (size < V1_HEADER_SIZE) {
+        std::cerr << sourceName << ": not a simulation state file" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data, V1_HEADER_SIZE);
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << sourceName << ": not a simulation state file" << std::endl;
+        return false;
+    }
+    if (header.endianTag != ENDIAN_TAG) {
+        std::cerr << sourceName << ": written on a machine with a different byte order" << std::endl;
+        return false;
+    }
+    if (header.version < 1 || header.version > VERSION) {
+        std::cerr << sourceName << ": state version " << header.version << ", expected 1 to " << VERSION << std::endl;
+        return false;
+    }
+    if (header.version >= 2) {
+        if (size < sizeof(header)) {
+            std::cerr << sourceName << ": not a simulation state file" << std::endl;
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+    } else {
+        // Version 1 had no fleet
+        ShipStore empty;
+        header.fleetFreeHead = empty.freeHead;
+        header.fleetTrailInterval = empty.trailInterval;
+    }
+    // Before version 3 collisions were always on (the field was padding)
+    if (header.version < 3) header.collisionsEnabled = 1;
+    if (header.fileSize != size) {
+        std::cerr << sourceName << ": truncated or padded (" << size << " bytes, header says " << header.fileSize << ")"
+                  << std::endl;
+        return false;
+    }
+
+    const uint64_t n = header.bodyCount;
+    if (n > size / 8) {
+        std::cerr << sourceName << ": body count out of range" << std::endl;
+        return false;
+    }
+    const uint64_t arrayBytes[BODY_ARRAYS] = {n * 8, n * 8, n * 8, n * 8, n * 8, n * 8, n * sizeof(int32_t)};
+    for (int a = 0; a < BODY_ARRAYS; a++) {
+        if (header.arrayOffset[a] % ALIGNMENT != 0 || !inside(header.arrayOffset[a], arrayBytes[a], size)) {
+            std::cerr << sourceName << ": body array out of range" << std::endl;
+            return false;
+        }
+    }
+    bool physical = true;
+    for (int a = 0; a < 6; a++) {
+        physical = physical && everyValue(data + header.arrayOffset[a], n, a < 4 ? finiteValue : positive);
+    }
+    if (!physical) {
+        std::cerr << sourceName << ": body state not finite, or a mass or radius not positive" << std::endl;
+        return false;
+    }
+    if (!finiteValue(header.simTime) || !finiteValue(header.timeWarpFactor) || !finiteValue(header.theta)) {
+        std::cerr << sourceName << ": time, warp or theta not finite" << std::endl;
+        return false;
+    }
+    const int32_t* parents = reinterpret_cast<const int32_t*>(data + header.arrayOffset[6]);
+    for (uint64_t i = 0; i < n; i++) {
+        if (parents[i] < -1 || parents[i] >= static_cast<int64_t>(i)) {
+            std::cerr << sourceName << ": body " << i << " has an invalid rails parent" << std::endl;
+            return false;
+        }
+    }
+    if (header.gravityMode != static_cast<int32_t>(GravitySolver::Mode::Exact) &&
+        header.gravityMode != static_cast<int32_t>(GravitySolver::Mode::BarnesHut)) {
+        std::cerr << sourceName << ": unknown gravity mode" << std::endl;
+        return false;
+    }
+
+    struct Info {
+        uint64_t index;
+        BodyInfo info;
+    };
+    std::vector<Info> infos;
+    uint64_t cursor = header.infoOffset;
+    for (uint64_t i = 0; i < header.infoCount; i++) {
+        InfoRecord record;
+        if (!inside(cursor, sizeof(record), size)) {
+            std::cerr << sourceName << ": render info out of range" << std::endl;
+            return false;
+        }
+        std::memcpy(&record, data + cursor, sizeof(record));
+        cursor += sizeof(record);
+        if (record.index >= n || !inside(cursor, record.spriteLength, size)) {
+            std::cerr << sourceName << ": render info out of range" << std::endl;
+            return false;
+        }
+        infos.push_back(Info{record.index, BodyInfo{std::string(data + cursor, record.spriteLength), record.renderSize}});
+        cursor += alignUp(record.spriteLength, 8);
+    }
+
+    ShipRecord ship = {};
+    const char* trail = nullptr;
+    if (header.shipOffset) {
+        if (!inside(header.shipOffset, sizeof(ship), size)) {
+            std::cerr << sourceName << ": ship out of range" << std::endl;
+            return false;
+        }
+        std::memcpy(&ship, data + header.shipOffset, sizeof(ship));
+        trail = data + header.shipOffset + sizeof(ship);
+        if (ship.trailCount > ship.trailCapacity || ship.trailCount > size / 16 ||
+            !inside(header.shipOffset + sizeof(ship), ship.trailCount * 16, size)) {
+            std::cerr << sourceName << ": ship trail out of range" << std::endl;
+            return false;
+        }
+        const double shipValues[] = {ship.x, ship.y, ship.vx, ship.vy, ship.fuel, ship.enginePower, ship.thrustX,
+                                     ship.thrustY, ship.trailMinDistance, ship.trailMaxInterval, ship.trailElapsed,
+                                     ship.soiThreshold, ship.integratorStep};
+        physical = positive(ship.mass);
+        for (double value : shipValues) physical = physical && finiteValue(value);
+        if (!physical) {
+            std::cerr << sourceName << ": ship state not finite, or its mass not positive" << std::endl;
+            return false;
+        }
+        if (ship.integrator < static_cast<int32_t>(IntegratorType::Euler) ||
+            ship.integrator > static_cast<int32_t>(IntegratorType::Yoshida4)) {
+            std::cerr << sourceName << ": unknown ship integrator" << std::endl;
+            return false;
+        }
+    }
+
+    ShipStore fleet;
+    if (!decodeFleet(header, data, size, fleet)) {
+        std::cerr << sourceName << ": fleet out of range, inconsistent or not physical" << std::endl;
+        return false;
+    }
+
+    // Bodies: one bulk copy per array straight out of the mapping
+    BodyStore& bodies = simulation.bodies;
+    std::vector<double>* doubles[6] = {&bodies.x, &bodies.y, &bodies.vx, &bodies.vy, &bodies.mass, &bodies.radius};
+    for (int a = 0; a < 6; a++) {
+        doubles[a]->resize(n);
+        if (n) std::memcpy(doubles[a]->data(), data + header.arrayOffset[a], arrayBytes[a]);
+    }
+    bodies.parent.assign(parents, parents + n);
+    bodies.layoutVersion++;
+
+    simulation.bodyInfo.assign(n, BodyInfo{std::string(), 0});
+    for (Info& entry : infos) {
+        simulation.bodyInfo[entry.index] = std::move(entry.info);
+    }
+
+    simulation.tick = header.tick;
+    simulation.simTime = header.simTime;
+    simulation.timeWarpFactor = header.timeWarpFactor;
+    simulation.diagnosticsEnabled = header.diagnosticsEnabled != 0;
+    simulation.collisionsEnabled = header.collisionsEnabled != 0;
+    simulation.lastTickSteps = 0;
+    simulation.pendingCommands.clear();
+    simulation.shipDrift.reset();
+    simulation.bodyDrift.reset();
+    simulation.gravity.setMode(static_cast<GravitySolver::Mode>(header.gravityMode));
+    simulation.gravity.setTheta(header.theta);
+    simulation.gravity.invalidate();
+
+    if (header.shipOffset) {
+        // Update in place so views holding the ship stay valid
+        if (!simulation.ship) {
+            simulation.ship = std::make_shared<Spacecraft>(ship.mass, Vector2D(), Vector2D(), ship.fuel, ship.enginePower);
+        }
+        Spacecraft& target = *simulation.ship;
+        target.position = Vector2D(ship.x, ship.y);
+        target.velocity = Vector2D(ship.vx, ship.vy);
+        target.mass = ship.mass;
+        target.fuel = ship.fuel;
+        target.enginePower = ship.enginePower;
+        target.thrustDirection = Vector2D(ship.thrustX, ship.thrustY);
+        target.thrustActive = ship.thrustActive != 0;
+        target.trailMinDistance = ship.trailMinDistance;
+        target.trailMaxInterval = ship.trailMaxInterval;
+        target.trailElapsed = ship.trailElapsed;
+        target.soiThreshold = ship.soiThreshold;
+        target.patchedConics = ship.patchedConics != 0;
+        target.onRails = ship.onRails != 0;
+        target.setIntegrator(static_cast<IntegratorType>(ship.integrator));
+        if (ship.integratorStep > 0) {
+            if (auto* adaptive = dynamic_cast<DormandPrinceIntegrator*>(target.integrator.get())) {
+                adaptive->currentStep = ship.integratorStep;
+            } else if (auto* fixed = dynamic_cast<FixedStepIntegrator*>(target.integrator.get())) {
+                fixed->maxStep = ship.integratorStep;
+            }
+        }
+
+        target.setTrailCapacity(static_cast<size_t>(ship.trailCapacity));
+        target.orbitTrail.clear();
+        for (uint64_t i = 0; i < ship.trailCount; i++) {
+            double xy[2];
+            std::memcpy(xy, trail + i * sizeof(xy), sizeof(xy));
+            target.orbitTrail.push(Vector2D(xy[0], xy[1]));
+        }
+        // Readers compare versions, so move past anything they may have cached
+        target.trailVersion = ship.trailVersion + 1;
+    } else {
+        simulation.ship.reset();
+    }
+
+    // Renderers must not pair packed indices across the load
+    fleet.layoutVersion = simulation.fleet.layoutVersion + 1;
+    simulation.fleet = std::move(fleet);
+    return true;
+}
+
+StateWriter::~StateWriter() {
+    wait();
+}
+
+bool StateWriter::saveAsync(const Simulation& simulation, const std::string& path) {
+    if (busy()) {
+        std::cerr << "Still writing the previous state, save skipped" << std::endl;
+        return false;
+    }
+    wait();
+
+    // Encoding is a few bulk copies; only the disk write leaves this thread
+    StateFile::encode(simulation, buffer);
+    writing = true;
+    worker = std::thread([this, path]() {
+        StateFile::writeBytes(buffer, path);
+        writing = false;
+    });
+    return true;
+}
+
+bool StateWriter::busy() const {
+    return writing;
+}
+
+void StateWriter::wait() {
+    if (worker.joinable()) worker.join();
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : threadCount(0), currentBody(nullptr), remaining(0), generation(0), stopping(false) {
+    setThreadCount(threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+unsigned ThreadPool::hardwareThreads() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::setThreadCount(unsigned count) {
+    if (count == 0) count = hardwareThreads();
+    if (count == threadCount) return;
+
+    stop();
+    threadCount = count;
+    start();
+}
+
+void ThreadPool::start() {
+    stopping = false;
+    queues.clear();
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    // The calling thread is worker 0, so only threadCount - 1 threads are spawned
+    for (unsigned i = 1; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+void ThreadPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        while (runOne(index)) {}
+    }
+}
+
+bool ThreadPool::runOne(unsigned index) {
+    Task task;
+    bool found = false;
+
+    // Own deque first, newest chunk
+    {
+        Queue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Otherwise steal the oldest chunk from another deque
+    for (unsigned k = 1; !found && k < threadCount; k++) {
+        Queue& victim = *queues[(index + k) % threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found) return false;
+
+    (*currentBody)(task.begin, task.end);
+
+    if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+
+    // Single-threaded mode, or not worth splitting
+    if (threadCount <= 1 || count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    size_t chunks = (count + grain - 1) / grain;
+    currentBody = &body;
+    remaining.store(chunks);
+
+    // Deal contiguous runs of chunks to each deque; stealing evens out the rest
+    size_t perQueue = (chunks + threadCount - 1) / threadCount;
+    for (size_t c = 0; c < chunks; c++) {
+        Queue& queue = *queues[c / perQueue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{c * grain, std::min(count, (c + 1) * grain)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        generation++;
+    }
+    wake.notify_all();
+
+    while (runOne(0)) {}
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    done.wait(lock, [&] { return remaining.load() == 0; });
+    currentBody = nullptr;
+}
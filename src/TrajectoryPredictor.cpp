@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../include/TrajectoryPredictor.h"
+#include "../include/Simulation.h"
+
+namespace {
+
+const double DRIFT_TOLERANCE = 1e-3;     // Restart when the ship is off the path by this share of its orbit radius
+const double APPROACH_SOI_MULTIPLE = 3;  // Closest approaches count within this many sphere radii
+const size_t MAX_PUBLISHED_EVENTS = 256;
+
+Vector2D lerp(const Vector2D& a, const Vector2D& b, double t) {
+    return a + (b - a) * t;
+}
+
+double distanceSquared(const Vector2D& a, const Vector2D& b) {
+    double dx = a.x - b.x, dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// Distance to the body pulling hardest at position; the scale drift is measured against
+double dominantDistance(const BodyStore& bodies, const Vector2D& position) {
+    double strongest = 0;
+    double distance = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < bodies.size(); i++) {
+        double d2 = distanceSquared(bodies.position(i), position);
+        if (d2 > 0 && bodies.mass[i] / d2 > strongest) {
+            strongest = bodies.mass[i] / d2;
+            distance = std::sqrt(d2);
+        }
+    }
+    return distance;
+}
+
+}
+
+TrajectoryPredictor::Path::Path() : gravity(bodies), ship(1, Vector2D(0, 0), Vector2D(0, 0), 0, 0) {
+    // A handful of bodies: the tree would cost more than it saves
+    gravity.setMode(GravitySolver::Mode::Exact);
+    ship.setTrailCapacity(1);
+}
+
+void TrajectoryPredictor::Path::restart(const Request& request, double stepSize) {
+    bodies = request.bodies;
+    gravity.invalidate();
+    simIndex = request.simIndex;
+    bodyLayout = request.bodyLayout;
+    fromThrust = request.thrusting;
+    step = stepSize;
+
+    // The coasting ship, stepped exactly as the simulation would step it
+    ship.position = request.position;
+    ship.velocity = request.velocity;
+    ship.mass = request.mass;
+    ship.thrustActive = false;
+    ship.patchedConics = request.patchedConics;
+    ship.soiThreshold = request.soiThreshold;
+    if (ship.integrator->type() != request.integrator) ship.setIntegrator(request.integrator);
+
+    baseTime = request.time;
+    points.assign(1, ship.position);
+    velocities.assign(1, ship.velocity);
+    events.clear();
+
+    const size_t n = bodies.size();
+    distance.assign(n, 0);
+    previousDistance.assign(n, 0);
+    soiRadius.assign(n, 0);
+    soiBody = -1;
+    detectEvents();
+}
+
+void TrajectoryPredictor::Path::advance() {
+    // Same order as Simulation::updatePhysics
+    gravity.prepare();
+    int primary = ship.coastingPrimary(gravity);
+    Vector2D relativePosition, relativeVelocity;
+    if (primary >= 0) {
+        relativePosition = ship.position - bodies.position(primary);
+        relativeVelocity = ship.velocity - bodies.velocity(primary);
+    } else {
+        ship.update(gravity, step);
+    }
+    gravity.stepBodies(step);
+    if (primary >= 0) ship.coast(gravity, primary, relativePosition, relativeVelocity, step);
+
+    points.push_back(ship.position);
+    velocities.push_back(ship.velocity);
+    detectEvents();
+}
+
+void TrajectoryPredictor::Path::detectEvents() {
+    const size_t n = bodies.size();
+    const size_t count = points.size();
+    const Vector2D here = points.back();
+    const double now = endTime();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // Laplace sphere of each body inside the heavier body pulling it hardest;
+    // the heaviest bodies reach everywhere
+    nextDistance.resize(n);
+    nextSoiRadius.resize(n);
+    for (size_t j = 0; j < n; j++) {
+        nextDistance[j] = (bodies.position(j) - here).magnitude();
+        int32_t parent = -1;
+        double strongest = 0, parentDistance2 = 0;
+        for (size_t k = 0; k < n; k++) {
+            if (!(bodies.mass[k] > bodies.mass[j])) continue;
+            double d2 = distanceSquared(bodies.position(k), bodies.position(j));
+            if (d2 > 0 && bodies.mass[k] / d2 > strongest) {
+                strongest = bodies.mass[k] / d2;
+                parentDistance2 = d2;
+                parent = static_cast<int32_t>(k);
+            }
+        }
+        nextSoiRadius[j] = parent < 0 ? inf : std::sqrt(parentDistance2) * std::pow(bodies.mass[j] / bodies.mass[parent], 0.4);
+    }
+
+    int32_t inside = -1;
+    for (size_t j = 0; j < n; j++) {
+        if (nextDistance[j] < nextSoiRadius[j] && (inside < 0 || nextSoiRadius[j] < nextSoiRadius[inside])) {
+            inside = static_cast<int32_t>(j);
+        }
+    }
+
+    // Crossings since the last point, placed where the distance meets the (moving) sphere
+    if (count > 1 && inside != soiBody) {
+        auto crossing = [&](TrajectoryEvent::Type type, int32_t j) {
+            double before = distance[j] - soiRadius[j];
+            double after = nextDistance[j] - nextSoiRadius[j];
+            double t = before != after ? std::min(std::max(before / (before - after), 0.0), 1.0) : 1.0;
+            events.push_back(TrajectoryEvent{type, simIndex[j], now - step + t * step, lerp(points[count - 2], here, t),
+                                             soiRadius[j] + (nextSoiRadius[j] - soiRadius[j]) * t});
+        };
+        if (soiBody >= 0 && nextDistance[soiBody] >= nextSoiRadius[soiBody]) crossing(TrajectoryEvent::Type::SoiExit, soiBody);
+        if (inside >= 0 && distance[inside] >= soiRadius[inside]) crossing(TrajectoryEvent::Type::SoiEnter, inside);
+    }
+    soiBody = inside;
+
+    // Closest approaches: a local minimum at the previous point, refined by a
+    // parabola through the last three distances
+    if (count > 2) {
+        for (size_t j = 0; j < n; j++) {
+            double d0 = previousDistance[j], d1 = distance[j], d2 = nextDistance[j];
+            if (!(d1 < d0 && d1 <= d2) || !(d1 < APPROACH_SOI_MULTIPLE * soiRadius[j])) continue;
+            double curvature = d0 - 2 * d1 + d2;
+            double offset = curvature > 0 ? 0.5 * (d0 - d2) / curvature : 0; // In steps, within +-0.5
+            double closest = curvature > 0 ? d1 - 0.125 * (d0 - d2) * (d0 - d2) / curvature : d1;
+            const Vector2D& middle = points[count - 2];
+            Vector2D position = offset >= 0 ? lerp(middle, here, offset) : lerp(middle, points[count - 3], -offset);
+            events.push_back(TrajectoryEvent{TrajectoryEvent::Type::ClosestApproach, simIndex[j],
+                                             now - step + offset * step, position, std::max(closest, 0.0)});
+        }
+    }
+
+    previousDistance.swap(distance);
+    distance.swap(nextDistance);
+    soiRadius.swap(nextSoiRadius);
+}
+
+void TrajectoryPredictor::Path::dropBefore(double time) {
+    // Keep the point at or before time, for interpolation
+    double passed = std::floor((time - baseTime) / step);
+    if (passed >= 1) {
+        size_t drop = std::min(static_cast<size_t>(passed), points.size() - 1);
+        points.erase(points.begin(), points.begin() + drop);
+        velocities.erase(velocities.begin(), velocities.begin() + drop);
+        baseTime += drop * step;
+    }
+    events.erase(std::remove_if(events.begin(), events.end(), [time](const TrajectoryEvent& e) { return e.time < time; }),
+                 events.end());
+}
+
+Vector2D TrajectoryPredictor::Path::positionAt(double time) const {
+    // Cubic Hermite between the neighbouring points
+    double along = (time - baseTime) / step;
+    size_t i = static_cast<size_t>(std::min(std::max(along, 0.0), static_cast<double>(points.size() - 1)));
+    if (i + 1 >= points.size()) return points.back();
+    double s = along - i;
+    double s2 = s * s, s3 = s2 * s;
+    return points[i] * (2 * s3 - 3 * s2 + 1) + velocities[i] * ((s3 - 2 * s2 + s) * step) +
+           points[i + 1] * (3 * s2 - 2 * s3) + velocities[i + 1] * ((s3 - s2) * step);
+}
+
+TrajectoryPredictor::TrajectoryPredictor() {}
+
+TrajectoryPredictor::~TrajectoryPredictor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void TrajectoryPredictor::capture(const Simulation& simulation, const std::vector<int32_t>& indices, Request& request) {
+    const BodyStore& all = simulation.bodies;
+    request.time = simulation.simTime;
+    request.bodyLayout = all.layoutVersion;
+    request.simIndex = indices;
+    all.copySubset(indices, request.bodies);
+
+    const Spacecraft& ship = *simulation.ship;
+    request.position = ship.position;
+    request.velocity = ship.velocity;
+    request.mass = ship.mass;
+    request.thrusting = ship.thrustActive;
+    request.integrator = ship.integrator->type();
+    request.patchedConics = ship.patchedConics;
+    request.soiThreshold = ship.soiThreshold;
+}
+
+void TrajectoryPredictor::fill(const Path& path, double from, Trajectory& out) {
+    size_t first = static_cast<size_t>(std::max(std::floor((from - path.baseTime) / path.step), 0.0));
+    first = std::min(first, path.points.size() - 1);
+    out.startTime = path.baseTime + first * path.step;
+    out.step = path.step;
+    out.points.assign(path.points.begin() + first, path.points.end());
+    out.bodyLayout = path.bodyLayout;
+
+    // Events come out of each step in body order; sort them for the reader
+    out.events.clear();
+    for (const TrajectoryEvent& event : path.events) {
+        if (event.time >= from) out.events.push_back(event);
+    }
+    std::stable_sort(out.events.begin(), out.events.end(),
+                     [](const TrajectoryEvent& a, const TrajectoryEvent& b) { return a.time < b.time; });
+    if (out.events.size() > MAX_PUBLISHED_EVENTS) out.events.resize(MAX_PUBLISHED_EVENTS);
+}
+
+void TrajectoryPredictor::submit(const Simulation& simulation) {
+    if (!simulation.ship) return;
+    if (!selectionValid || selectedLayout != simulation.bodies.layoutVersion) {
+        simulation.bodies.selectMassive(PREDICTION_MASS_FRACTION, PREDICTION_MAX_BODIES, selected);
+        selectedLayout = simulation.bodies.layoutVersion;
+        selectionValid = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        capture(simulation, selected, pending);
+        hasPending = true;
+        if (!worker.joinable()) worker = std::thread(&TrajectoryPredictor::run, this);
+    }
+    wake.notify_one();
+}
+
+const Trajectory& TrajectoryPredictor::latest() {
+    results.update();
+    return results.readBuffer();
+}
+
+Trajectory TrajectoryPredictor::predict(const Simulation& simulation, double horizon, double step) {
+    Request request;
+    std::vector<int32_t> indices;
+    simulation.bodies.selectMassive(PREDICTION_MASS_FRACTION, PREDICTION_MAX_BODIES, indices);
+    capture(simulation, indices, request);
+
+    Path path;
+    path.restart(request, step);
+    while (path.endTime() < request.time + horizon) path.advance();
+
+    Trajectory out;
+    fill(path, request.time, out);
+    return out;
+}
+
+void TrajectoryPredictor::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || hasPending; });
+        if (stopping) return;
+        std::swap(pending, working);
+        hasPending = false;
+        lock.unlock();
+
+        if (process(working)) {
+            Trajectory& out = results.writeBuffer();
+            fill(path, working.time, out);
+            out.version = ++publishCount;
+            results.publish();
+        }
+
+        lock.lock();
+    }
+}
+
+bool TrajectoryPredictor::process(const Request& request) {
+    bool restart = path.points.empty() || request.thrusting || path.fromThrust || request.bodyLayout != path.bodyLayout ||
+                   step != path.step || request.integrator != path.ship.integrator->type() ||
+                   request.patchedConics != path.ship.patchedConics || request.soiThreshold != path.ship.soiThreshold ||
+                   request.time < path.baseTime || request.time > path.endTime();
+    if (!restart) {
+        // The simulation steps differently, so the ship slowly leaves the path
+        double off = (path.positionAt(request.time) - request.position).magnitude();
+        restart = off > DRIFT_TOLERANCE * dominantDistance(request.bodies, request.position);
+    }
+
+    bool changed = restart;
+    if (restart) {
+        path.restart(request, step);
+    } else {
+        double base = path.baseTime;
+        size_t eventCount = path.events.size();
+        path.dropBefore(request.time);
+        changed = path.baseTime != base || path.events.size() != eventCount;
+    }
+    while (path.endTime() < request.time + horizon) {
+        path.advance();
+        changed = true;
+    }
+    return changed;
+}
@@ -0,0 +1,47 @@
+#include "../include/ViewCuller.h"
+#include "../include/Constants.h"
+
+void ViewCuller::update(const double* x, const double* y, const uint8_t* pinned, size_t n,
+                        Vector2D cameraOffset, double scale, double marginPixels, double marginWorld) {
+    visible.clear();
+    clusters.clear();
+
+    // Viewport in world coordinates, grown by the margin
+    double margin = marginPixels / scale + marginWorld;
+    double minX = (-SCREEN_WIDTH / 2 - cameraOffset.x) / scale - margin;
+    double maxX = (SCREEN_WIDTH / 2 - cameraOffset.x) / scale + margin;
+    double minY = (-SCREEN_HEIGHT / 2 - cameraOffset.y) / scale - margin;
+    double maxY = (SCREEN_HEIGHT / 2 - cameraOffset.y) / scale + margin;
+
+    bulkX.clear();
+    bulkY.clear();
+    bulkIndex.clear();
+    for (size_t i = 0; i < n; i++) {
+        if (pinned && pinned[i]) {
+            if (x[i] >= minX && x[i] <= maxX && y[i] >= minY && y[i] <= maxY) {
+                visible.push_back(static_cast<uint32_t>(i));
+            }
+        } else {
+            bulkX.push_back(x[i]);
+            bulkY.push_back(y[i]);
+            bulkIndex.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    if (bulkX.empty()) return;
+
+    // Unit weights, so cluster centers are centroids
+    bulkWeight.assign(bulkX.size(), 1.0);
+    tree.build(bulkX.data(), bulkY.data(), bulkWeight.data(), nullptr, bulkX.size());
+
+    hits.clear();
+    clusterNodes.clear();
+    tree.query(minX, minY, maxX, maxY, 1.0 / scale, hits, clusterNodes);
+
+    for (uint32_t k : hits) {
+        visible.push_back(bulkIndex[tree.order[k]]);
+    }
+    for (int32_t nodeIndex : clusterNodes) {
+        const QuadTree::Node& node = tree.nodes[nodeIndex];
+        clusters.push_back(Vector2D(node.comX, node.comY));
+    }
+}
@@ -0,0 +1,41 @@
+# Flies a ship around a lone star for a year on Kepler conics and again
+# integrated numerically (--no-conics), on an elliptic and on a hyperbolic
+# orbit, and checks that both paths end in the same place.
+# Run by ctest: cmake -DHEADLESS=<SpaceSimHeadless> -DWORK_DIR=<dir> -P KeplerConics.cmake
+
+# Both agree to centimeters; a kilometer still catches a wrong conic
+set(tolerance 1000)
+
+# Sets <prefix>_x and <prefix>_y to the ship's final position in whole meters
+function(ship_position prefix scenario)
+    execute_process(COMMAND "${HEADLESS}" --scenario "${scenario}" --seconds 31557600 ${ARGN}
+                    RESULT_VARIABLE result OUTPUT_VARIABLE json ERROR_VARIABLE log)
+    if(NOT result STREQUAL "0")
+        message(FATAL_ERROR "SpaceSimHeadless --scenario ${scenario} ${ARGN} exited with ${result}:\n${log}")
+    endif()
+    if(NOT json MATCHES "\"ship\": {\"x\": (-?[0-9]+)[^,]*, \"y\": (-?[0-9]+)")
+        message(FATAL_ERROR "No ship in:\n${json}")
+    endif()
+    set(${prefix}_x ${CMAKE_MATCH_1} PARENT_SCOPE)
+    set(${prefix}_y ${CMAKE_MATCH_2} PARENT_SCOPE)
+endfunction()
+
+# 1 AU from the Sun: 29.8 km/s is circular and 42.1 km/s escapes
+foreach(orbit elliptic:35000 hyperbolic:50000)
+    string(REPLACE ":" ";" orbit ${orbit})
+    list(GET orbit 0 name)
+    list(GET orbit 1 speed)
+    set(scenario "${WORK_DIR}/kepler_${name}.scn")
+    file(WRITE "${scenario}"
+         "body name=star mass=1.989e30 radius=696340000 x=0 y=0 vx=0 vy=0\n"
+         "ship mass=1000 fuel=0 power=0 x=1.5e11 y=0 vx=0 vy=${speed}\n")
+
+    ship_position(conic "${scenario}")
+    ship_position(numeric "${scenario}" --no-conics)
+    math(EXPR dx "${conic_x} - ${numeric_x}")
+    math(EXPR dy "${conic_y} - ${numeric_y}")
+    if(dx GREATER ${tolerance} OR dx LESS -${tolerance} OR dy GREATER ${tolerance} OR dy LESS -${tolerance})
+        message(FATAL_ERROR "The ${name} conic ends at ${conic_x}, ${conic_y} m; integrated, it ends at "
+                            "${numeric_x}, ${numeric_y} m")
+    endif()
+endforeach()
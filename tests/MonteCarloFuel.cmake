@@ -0,0 +1,35 @@
+# Flies dispersed copies of a burn shorter than the ship's tank and checks that
+# the fuel they use follows their thrust errors, and stays within the tank.
+# Run by ctest: cmake -DHEADLESS=<SpaceSimHeadless> -P MonteCarloFuel.cmake
+
+# The default ship burns 500 fuel a second from 1000, so a 1 s burn uses half
+set(session --monte-carlo 200 --seconds 864000 --burn 3600:3601:90 --target 1)
+
+# Sets <prefix>_mean, _stddev and _max from a --monte-carlo run's fuelUsed
+function(fuel_used prefix)
+    execute_process(COMMAND "${HEADLESS}" ${session} ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE json
+                    ERROR_VARIABLE log)
+    if(NOT result STREQUAL "0")
+        message(FATAL_ERROR "SpaceSimHeadless ${session} ${ARGN} exited with ${result}:\n${log}")
+    endif()
+    if(NOT json MATCHES "\"fuelUsed\": {\"mean\": ([^,]+), \"stddev\": ([^,]+),.* \"max\": ([^}]+)}")
+        message(FATAL_ERROR "No fuelUsed in:\n${json}")
+    endif()
+    set(${prefix}_mean ${CMAKE_MATCH_1} PARENT_SCOPE)
+    set(${prefix}_stddev ${CMAKE_MATCH_2} PARENT_SCOPE)
+    set(${prefix}_max ${CMAKE_MATCH_3} PARENT_SCOPE)
+endfunction()
+
+fuel_used(dispersed --disperse 1000:0.1:0.01:0.5)
+if(NOT dispersed_stddev GREATER 0)
+    message(FATAL_ERROR "fuelUsed doesn't vary with 1% thrust errors: stddev ${dispersed_stddev}")
+endif()
+if(dispersed_mean LESS 450 OR dispersed_mean GREATER 550 OR dispersed_max GREATER 1000)
+    message(FATAL_ERROR "fuelUsed mean ${dispersed_mean}, max ${dispersed_max}; expected about 500, at most 1000")
+endif()
+
+# Without thrust errors every ship burns the same second
+fuel_used(exact --disperse 1000:0.1:0:0.5)
+if(NOT exact_stddev EQUAL 0)
+    message(FATAL_ERROR "fuelUsed varies without thrust errors: stddev ${exact_stddev}")
+endif()
@@ -0,0 +1,31 @@
+# Builds a porkchop plot between two circular orbits and checks that its
+# cheapest cell is the Hohmann transfer: both burns and the flight time.
+# Run by ctest: cmake -DHEADLESS=<SpaceSimHeadless> -DWORK_DIR=<dir> -P PorkchopHohmann.cmake
+
+get_filename_component(scenario "${CMAKE_CURRENT_LIST_DIR}/hohmann.scn" ABSOLUTE)
+execute_process(COMMAND "${HEADLESS}" --scenario "${scenario}" --seconds 0 --transfer 1:2 --grid 200
+                        --porkchop "${WORK_DIR}/hohmann_porkchop.csv"
+                RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE log)
+if(NOT result STREQUAL "0")
+    message(FATAL_ERROR "SpaceSimHeadless --porkchop exited with ${result}:\n${log}")
+endif()
+if(NOT log MATCHES "cheapest: [^\n]*, ([^ ]+) \\+ ([^ ]+) m/s over ([^ ]+) days")
+    message(FATAL_ERROR "No cheapest transfer in:\n${log}")
+endif()
+set(departure ${CMAKE_MATCH_1})
+set(arrival ${CMAKE_MATCH_2})
+set(days ${CMAKE_MATCH_3})
+
+# Hohmann from r1 = 1.496e11 m to r2 = 2.279e11 m around G * 1.989e30:
+# 2943.9 m/s to leave, 2648.3 m/s to arrive, 258.8 days. The grid is 1% of
+# a transfer time apart, so the cheapest cell is allowed 1% on each burn and
+# 3% on the flight time.
+if(departure LESS 2914.5 OR departure GREATER 2973.3)
+    message(FATAL_ERROR "Departure burn ${departure} m/s, Hohmann is 2943.9 m/s")
+endif()
+if(arrival LESS 2621.8 OR arrival GREATER 2674.8)
+    message(FATAL_ERROR "Arrival burn ${arrival} m/s, Hohmann is 2648.3 m/s")
+endif()
+if(days LESS 251 OR days GREATER 266.6)
+    message(FATAL_ERROR "Flight time ${days} days, Hohmann is 258.8 days")
+endif()
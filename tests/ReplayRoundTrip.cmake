@@ -0,0 +1,31 @@
+# Records a headless session with a burn, then checks that replaying it and
+# seeking into it from a keyframe reproduce the recorded states bit for bit.
+# Run by ctest: cmake -DHEADLESS=<SpaceSimHeadless> -DWORK_DIR=<dir> -P ReplayRoundTrip.cmake
+
+set(session --deterministic --step 3600 --burn 7200:7202:90)
+
+function(run_headless)
+    execute_process(COMMAND "${HEADLESS}" ${ARGN} RESULT_VARIABLE result ERROR_VARIABLE log)
+    if(NOT result STREQUAL "0")
+        message(FATAL_ERROR "SpaceSimHeadless ${ARGN} exited with ${result}:\n${log}")
+    endif()
+endfunction()
+
+function(expect_same_file a b)
+    file(READ "${a}" first)
+    file(READ "${b}" second)
+    if(NOT first STREQUAL second)
+        message(FATAL_ERROR "${a} and ${b} differ")
+    endif()
+endfunction()
+
+# 2000 ticks, so there is a second keyframe (every 1800 ticks) to seek from
+run_headless(${session} --seconds 7200000 --record "${WORK_DIR}/roundtrip.rpl" --out "${WORK_DIR}/roundtrip_recorded.json")
+run_headless(${session} --seconds 6840000 --record "${WORK_DIR}/roundtrip_short.rpl" --out "${WORK_DIR}/roundtrip_1900.json")
+
+# --replay exits 2 if the final state's hash differs from the recorded one
+run_headless(--replay "${WORK_DIR}/roundtrip.rpl" --out "${WORK_DIR}/roundtrip_replayed.json")
+expect_same_file("${WORK_DIR}/roundtrip_recorded.json" "${WORK_DIR}/roundtrip_replayed.json")
+
+run_headless(--replay "${WORK_DIR}/roundtrip.rpl" --seek 1900 --out "${WORK_DIR}/roundtrip_seek.json")
+expect_same_file("${WORK_DIR}/roundtrip_1900.json" "${WORK_DIR}/roundtrip_seek.json")
@@ -0,0 +1,330 @@
+// Runs the simulation without a window for a fixed span of simulated time,
+// as fast as the machine allows, then writes the final state as JSON.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../include/Simulation.h"
+#include "../include/Profiler.h"
+#include "../include/StateFile.h"
+#include "../include/ScenarioLoader.h"
+#include "../include/Replay.h"
+#include "../include/TrajectoryPredictor.h"
+#include "../include/Porkchop.h"
+#include "../include/MonteCarlo.h"
+
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --seconds S        simulated seconds to run (default 31557600, one year)\n"
+              << "  --step DT          max physics step in seconds (default 3600)\n"
+              << "  --threads N        physics worker threads, 0 = all cores (default 1)\n"
+              << "  --integrator NAME  ship integrator: Euler, RK4, DormandPrince45, Leapfrog, Yoshida4\n"
+              << "  --gravity MODE     exact or barnes-hut (default barnes-hut)\n"
+              << "  --theta T          Barnes-Hut opening angle, 0 to 1\n"
+              << "  --no-conics        always integrate the ship numerically\n"
+              << "  --no-collisions    let everything pass through everything\n"
+              << "  --deterministic    fixed scalar gravity kernel, bit-identical on every CPU\n"
+              << "  --scenario FILE    build the system from a scenario file instead of the built-in one\n"
+              << "  --load FILE        start from a saved binary state\n"
+              << "  --save FILE        write the final state as a binary state file\n"
+              << "  --record FILE      run --seconds as ticks of --step seconds and record them for --replay\n"
+              << "  --replay FILE      re-run a recorded session instead of --seconds; exits 2 if it diverges\n"
+              << "  --seek TICK        stop the replay at the start of this tick (default: its end)\n"
+              << "  --predict S        afterwards, predict S seconds of coasting and list its events\n"
+              << "  --porkchop FILE    afterwards, write a porkchop plot of total transfer delta-v as CSV\n"
+              << "  --transfer A:B     its departure and arrival: body indices, or ship for A (default ship:1)\n"
+              << "  --grid N           its departure and arrival times per axis (default 1000)\n"
+              << "  --monte-carlo N    instead of the run, fly N dispersed copies of the ship for --seconds\n"
+              << "  --seed N           their random seed (default 1)\n"
+              << "  --burn T0:T1:DEG   their burn, or the recording's: T0 to T1 seconds, DEG degrees from +x\n"
+              << "  --disperse P:V:T:A their errors: position m, velocity m/s, thrust fraction, pointing degrees\n"
+              << "                     (default 1000:0.1:0.01:0.5)\n"
+              << "  --target B         miss distance is their closest approach to body B (default: the nominal end)\n"
+              << "  --out FILE         write the final state here instead of stdout\n"
+              << "  --trace FILE       write profiled scopes as Chrome trace-event JSON\n";
+}
+
+int main(int argc, char* args[]) {
+    double seconds = 365.25 * 86400;
+    double step = 3600;
+    unsigned threads = 1;
+    std::string outPath, tracePath, savePath, replayPath, recordPath;
+    long long seekTick = -1;
+    double predictSeconds = 0;
+    std::string porkchopPath, transfer = "ship:1";
+    size_t gridSize = 1000;
+    DispersionRunner dispersion;
+    bool burnGiven = false;
+    dispersion.instances = 0;
+    dispersion.dispersion = Dispersion{1000, 0.1, 0.01, 0.5 * M_PI / 180};
+
+    // The starting state comes first so the other options can adjust it
+    Simulation simulation;
+    std::string loadPath, scenarioPath;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(args[i], "--load") == 0) loadPath = args[i + 1];
+        if (std::strcmp(args[i], "--scenario") == 0) scenarioPath = args[i + 1];
+    }
+    if (loadPath.empty() && scenarioPath.empty()) {
+        simulation.createDefaultScenario();
+    } else {
+        std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+        bool loaded = loadPath.empty() ? ScenarioLoader::load(simulation, scenarioPath) : StateFile::load(simulation, loadPath);
+        if (!loaded) return 1;
+        std::cerr << "Loaded " << simulation.bodies.size() << " bodies and " << simulation.fleet.size() << " fleet ships in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count() << " s" << std::endl;
+        if (!simulation.ship) simulation.createDefaultShip();
+    }
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if ((std::strcmp(args[i], "--load") == 0 || std::strcmp(args[i], "--scenario") == 0) && hasValue) {
+            i++;
+        } else if (std::strcmp(args[i], "--save") == 0 && hasValue) {
+            savePath = args[++i];
+        } else if (std::strcmp(args[i], "--record") == 0 && hasValue) {
+            recordPath = args[++i];
+        } else if (std::strcmp(args[i], "--replay") == 0 && hasValue) {
+            replayPath = args[++i];
+        } else if (std::strcmp(args[i], "--seek") == 0 && hasValue) {
+            seekTick = std::atoll(args[++i]);
+        } else if (std::strcmp(args[i], "--seconds") == 0 && hasValue) {
+            seconds = std::atof(args[++i]);
+        } else if (std::strcmp(args[i], "--step") == 0 && hasValue) {
+            step = std::atof(args[++i]);
+        } else if (std::strcmp(args[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(args[++i]));
+        } else if (std::strcmp(args[i], "--integrator") == 0 && hasValue) {
+            IntegratorType type;
+            if (!Integrator::fromName(args[++i], type)) {
+                std::cerr << "Unknown integrator: " << args[i] << std::endl;
+                return 1;
+            }
+            simulation.ship->setIntegrator(type);
+        } else if (std::strcmp(args[i], "--gravity") == 0 && hasValue) {
+            std::string mode = args[++i];
+            if (mode == "exact") {
+                simulation.gravity.setMode(GravitySolver::Mode::Exact);
+            } else if (mode == "barnes-hut") {
+                simulation.gravity.setMode(GravitySolver::Mode::BarnesHut);
+            } else {
+                std::cerr << "Unknown gravity mode: " << mode << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(args[i], "--theta") == 0 && hasValue) {
+            double theta = std::atof(args[++i]);
+            simulation.gravity.setTheta(theta);
+            if (simulation.gravity.getTheta() != theta) {
+                std::cerr << "Barnes-Hut theta clamped to " << simulation.gravity.getTheta() << std::endl;
+            }
+        } else if (std::strcmp(args[i], "--deterministic") == 0) {
+            simulation.setDeterministic(true);
+        } else if (std::strcmp(args[i], "--no-conics") == 0) {
+            simulation.ship->patchedConics = false;
+        } else if (std::strcmp(args[i], "--no-collisions") == 0) {
+            simulation.collisionsEnabled = false;
+        } else if (std::strcmp(args[i], "--predict") == 0 && hasValue) {
+            predictSeconds = std::atof(args[++i]);
+        } else if (std::strcmp(args[i], "--porkchop") == 0 && hasValue) {
+            porkchopPath = args[++i];
+        } else if (std::strcmp(args[i], "--transfer") == 0 && hasValue) {
+            transfer = args[++i];
+        } else if (std::strcmp(args[i], "--grid") == 0 && hasValue) {
+            gridSize = static_cast<size_t>(std::max(std::atoi(args[++i]), 1));
+        } else if (std::strcmp(args[i], "--monte-carlo") == 0 && hasValue) {
+            dispersion.instances = static_cast<size_t>(std::max(std::atoll(args[++i]), 0LL));
+        } else if (std::strcmp(args[i], "--seed") == 0 && hasValue) {
+            dispersion.seed = std::strtoull(args[++i], nullptr, 10);
+        } else if (std::strcmp(args[i], "--burn") == 0 && hasValue) {
+            double degrees = 0;
+            if (std::sscanf(args[++i], "%lf:%lf:%lf", &dispersion.maneuver.start, &dispersion.maneuver.end, &degrees) != 3) {
+                std::cerr << "--burn takes T0:T1:DEG" << std::endl;
+                return 1;
+            }
+            dispersion.maneuver.direction = Vector2D(std::cos(degrees * M_PI / 180), std::sin(degrees * M_PI / 180));
+            burnGiven = true;
+        } else if (std::strcmp(args[i], "--disperse") == 0 && hasValue) {
+            Dispersion& d = dispersion.dispersion;
+            if (std::sscanf(args[++i], "%lf:%lf:%lf:%lf", &d.position, &d.velocity, &d.thrust, &d.pointing) != 4) {
+                std::cerr << "--disperse takes P:V:T:A" << std::endl;
+                return 1;
+            }
+            d.pointing *= M_PI / 180;
+        } else if (std::strcmp(args[i], "--target") == 0 && hasValue) {
+            dispersion.target = std::atoi(args[++i]);
+        } else if (std::strcmp(args[i], "--out") == 0 && hasValue) {
+            outPath = args[++i];
+        } else if (std::strcmp(args[i], "--trace") == 0 && hasValue) {
+            tracePath = args[++i];
+        } else {
+            usage(args[0]);
+            return 1;
+        }
+    }
+
+    if (seconds < 0 || step <= 0) {
+        std::cerr << "--seconds must be >= 0 and --step > 0" << std::endl;
+        return 1;
+    }
+    simulation.physicsPool.setThreadCount(threads);
+    // Timing every step costs a little; only pay for it when asked
+    Profiler::setEnabled(!tracePath.empty());
+
+    int exitCode = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (dispersion.instances > 0) {
+        // Each copy flies --seconds from the starting state; the results replace the final state
+        dispersion.duration = seconds;
+        dispersion.maxStep = step;
+        size_t nextReport = 0;
+        dispersion.progress = [&](size_t done, double missMean, double missStddev) {
+            if (done < nextReport && done < dispersion.instances) return;
+            nextReport = done + dispersion.instances / 10;
+            std::cerr << "  " << done << "/" << dispersion.instances << " ships: miss " << missMean << " +- " << missStddev
+                      << " m" << std::endl;
+        };
+        if (!dispersion.run(simulation, &simulation.physicsPool)) {
+            std::cerr << "Nothing to disperse: needs a ship, --seconds > 0 and a --target that is a body" << std::endl;
+            return 1;
+        }
+        std::cerr << "Flew " << dispersion.instances << " dispersed ships in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s wall" << std::endl;
+        std::cerr << "  miss p50 " << dispersion.missDistance.p50 << " m, p90 " << dispersion.missDistance.p90 << " m, p99 "
+                  << dispersion.missDistance.p99 << " m; fuel " << dispersion.fuelUsed.mean << " +- "
+                  << dispersion.fuelUsed.stddev << std::endl;
+        if (outPath.empty()) {
+            dispersion.writeJson(std::cout);
+        } else {
+            std::ofstream out(outPath);
+            if (!out) {
+                std::cerr << "Failed to open " << outPath << std::endl;
+                return 1;
+            }
+            dispersion.writeJson(out);
+        }
+        return 0;
+    }
+
+    if (!recordPath.empty()) {
+        // Ticks as the game runs them at a warp of one --step per tick, with
+        // --burn as thrust commands, so the session exercises the command log
+        ReplayRecorder recorder;
+        if (!recorder.start(simulation, recordPath, REPLAY_KEYFRAME_TICKS)) return 1;
+        const uint64_t first = simulation.tick;
+        const uint64_t ticks = static_cast<uint64_t>(std::ceil(seconds / step));
+        simulation.queueCommand(SimCommand{SimCommand::Type::SetWarp, false, Vector2D(), step / TIME_STEP, first});
+        if (burnGiven) {
+            const Maneuver& burn = dispersion.maneuver;
+            uint64_t on = first + static_cast<uint64_t>(std::max(std::floor(burn.start / step), 0.0));
+            uint64_t off = std::max(first + static_cast<uint64_t>(std::max(std::ceil(burn.end / step), 0.0)), on + 1);
+            simulation.queueCommand(SimCommand{SimCommand::Type::Thrust, true, burn.direction, 0, on});
+            simulation.queueCommand(SimCommand{SimCommand::Type::Thrust, false, burn.direction, 0, off});
+        }
+        for (uint64_t i = 0; i < ticks; i++) {
+            recorder.beforeTick(simulation);
+            simulation.runTick();
+        }
+        recorder.finish(simulation);
+    } else if (replayPath.empty()) {
+        simulation.advance(seconds, step);
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Simulated " << simulation.simTime << " s in " << wall << " s wall ("
+                  << (wall > 0 ? simulation.simTime / wall : 0) << "x real time)" << std::endl;
+    } else {
+        // Ticks exactly as the recording ran them, as fast as they go
+        ReplayPlayer replay;
+        if (!replay.load(replayPath)) return 1;
+        uint64_t target = seekTick >= 0 ? static_cast<uint64_t>(seekTick) : replay.endTick;
+        if (!replay.seek(simulation, target)) return 1;
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Replayed to tick " << simulation.tick << " of " << replay.endTick << " in " << wall << " s wall"
+                  << std::endl;
+
+        if (simulation.tick == replay.endTick && replay.endHash) {
+            if (ReplayPlayer::stateHash(simulation) == replay.endHash) {
+                std::cerr << "Final state matches the recording" << std::endl;
+            } else {
+                std::cerr << "Final state differs from the recording" << std::endl;
+                exitCode = 2;
+            }
+        }
+    }
+
+    if (predictSeconds > 0) {
+        static const char* const eventNames[] = {"closest approach", "SOI exit", "SOI enter"};
+        std::chrono::steady_clock::time_point predictStart = std::chrono::steady_clock::now();
+        Trajectory path = TrajectoryPredictor::predict(simulation, predictSeconds, PREDICTION_STEP);
+        std::cerr << "Predicted " << path.points.size() << " points in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - predictStart).count() << " s wall"
+                  << std::endl;
+        for (const TrajectoryEvent& event : path.events) {
+            std::cerr << "  t=" << event.time << " s: " << eventNames[static_cast<int>(event.type)] << ", body "
+                      << event.body << ", " << event.distance << " m" << std::endl;
+        }
+    }
+
+    if (!porkchopPath.empty()) {
+        size_t colon = transfer.find(':');
+        std::string from = transfer.substr(0, colon);
+        size_t to = colon == std::string::npos ? 0 : static_cast<size_t>(std::atoi(transfer.c_str() + colon + 1));
+        PorkchopPlot plot;
+        bool valid = colon != std::string::npos &&
+                     (from == "ship" ? plot.setShip(simulation.bodies, simulation.ship->position, simulation.ship->velocity, to,
+                                                    simulation.simTime)
+                                     : plot.setBodies(simulation.bodies, static_cast<size_t>(std::atoi(from.c_str())), to,
+                                                      simulation.simTime));
+        if (!valid) {
+            std::cerr << "No transfer " << transfer << " around a central body" << std::endl;
+            return 1;
+        }
+        plot.defaultWindows(gridSize);
+        std::chrono::steady_clock::time_point plotStart = std::chrono::steady_clock::now();
+        plot.compute(&simulation.physicsPool);
+        std::cerr << "Porkchop " << plot.departures << "x" << plot.arrivals << " around body " << plot.central << " in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - plotStart).count() << " s wall"
+                  << std::endl;
+        size_t bestDeparture, bestArrival;
+        if (plot.cheapest(bestDeparture, bestArrival)) {
+            std::cerr << "  cheapest: depart t=" << plot.departureTime(bestDeparture) << " s, arrive t="
+                      << plot.arrivalTime(bestArrival) << " s, " << plot.departureDeltaV[bestDeparture * plot.arrivals + bestArrival]
+                      << " + " << plot.arrivalDeltaV[bestDeparture * plot.arrivals + bestArrival] << " m/s over "
+                      << (plot.arrivalTime(bestArrival) - plot.departureTime(bestDeparture)) / 86400 << " days" << std::endl;
+        }
+
+        std::ofstream csv(porkchopPath);
+        if (!csv) {
+            std::cerr << "Failed to open " << porkchopPath << std::endl;
+            return 1;
+        }
+        plot.writeCsv(csv);
+    }
+
+    if (!savePath.empty() && !StateFile::save(simulation, savePath)) return 1;
+
+    if (!tracePath.empty()) {
+        std::ofstream trace(tracePath);
+        if (!trace) {
+            std::cerr << "Failed to open " << tracePath << std::endl;
+            return 1;
+        }
+        Profiler::writeChromeTrace(trace);
+    }
+
+    if (outPath.empty()) {
+        simulation.writeState(std::cout);
+    } else {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "Failed to open " << outPath << std::endl;
+            return 1;
+        }
+        simulation.writeState(out);
+    }
+    return exitCode;
+}